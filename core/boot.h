@@ -0,0 +1,151 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include "chip8.h"
+#include "instructions.h"
+#include "parser.h"
+
+// The machine state as plain values, so the instruction handlers run on it in constant
+// expressions: the same ExecuteInstruction() the interpreter uses, with no debugger, trace,
+// keypad or random generator behind it. Used to check opcode semantics with static_assert and
+// to bake the boot of bundled ROMs into the binary.
+struct BootMachine {
+    // Flat 4 KB with the Memory interface the handlers use (addresses wrap at 4 KB)
+    struct Bytes {
+        std::array<uint8_t, 4096> bytes = {};
+
+        constexpr uint8_t operator[](size_t address) const { return bytes[address & 0xFFF]; }
+        constexpr void Write(size_t address, uint8_t value) { bytes[address & 0xFFF] = value; }
+    };
+
+    // Only reachable if a caller steps over Cxkk, which Bake() never does
+    struct NoRandom {
+        constexpr uint8_t operator()() { return 0; }
+    };
+
+    Bytes memory;
+    std::array<uint8_t, 16> registers = {};
+    std::array<uint16_t, 16> stack = {};
+    Chip8::Display display = {};
+    std::array<uint8_t, 16> keypad = {};
+
+    uint8_t sp = 0;
+    uint16_t pc = Chip8::kStartAddress;
+    uint16_t index = 0;
+    uint8_t delayTimer = 0;
+    uint8_t soundTimer = 0;
+    uint16_t opcode = 0;
+    Chip8::CpuState cpuState = Chip8::CpuState::Running;
+    uint8_t waitRegister = 0;
+    Chip8::Trap trap = Chip8::Trap::None;
+
+    Quirks quirks;
+    Chip8::Counters counters;
+    Debugger* debugger = nullptr;
+    bool redraw = false;
+    NoRandom rand;
+
+    // Font and program, as Chip8::CreateImage lays them out
+    constexpr void Load(std::span<const uint8_t> rom) {
+        for (size_t i = 0; i < Chip8::kSprites.size(); ++i) memory.bytes[0x50 + i] = Chip8::kSprites[i];
+        for (size_t i = 0; i < rom.size() && i < size_t(Chip8::kMaxRomSize); ++i) memory.bytes[Chip8::kStartAddress + i] = rom[i];
+    }
+
+    [[nodiscard]] constexpr uint16_t Fetch() const { return uint16_t(memory[pc] << 8 | memory[pc + 1]); }
+
+    // One Tick() without polling: fetch, advance and execute
+    constexpr void Step() {
+        if (pc > 0xFFF) {
+            Raise(Chip8::Trap::OutOfRange, pc);
+            return;
+        }
+        opcode = Fetch();
+        pc += 2;
+        ExecuteInstruction(this, parse(opcode));
+        if (cpuState != Chip8::CpuState::Trapped) counters.instructions++;
+    }
+
+    constexpr void TickTimer() {
+        counters.timerTicks++;
+        if (delayTimer > 0) delayTimer--;
+        if (soundTimer > 0) soundTimer--;
+    }
+
+    constexpr void Raise(Chip8::Trap trap, uint16_t address) {
+        this->trap = trap;
+        cpuState = Chip8::CpuState::Trapped;
+        pc = address;
+    }
+
+    // The held-key snapshot Chip8 keeps for Fx0A is always empty here, no key is ever down
+    constexpr void WaitForKey(uint8_t x) {
+        cpuState = Chip8::CpuState::WaitingForKey;
+        waitRegister = x;
+    }
+
+    [[nodiscard]] constexpr bool IsPressed(uint8_t key) const { return key < 16 && keypad[key]; }
+
+    // Everything but the random generator, which the caller fills in from the instance it loads into
+    [[nodiscard]] constexpr Chip8::State ToState() const {
+        Chip8::State state = {};
+        state.memory = memory.bytes;
+        state.registers = registers;
+        state.stack = stack;
+        state.display = display;
+        state.keypad = keypad;
+        state.sp = sp;
+        state.pc = pc;
+        state.index = index;
+        state.delayTimer = delayTimer;
+        state.soundTimer = soundTimer;
+        state.opcode = opcode;
+        state.cpuState = cpuState;
+        state.waitRegister = waitRegister;
+        state.waitKey = -1;
+        state.waitHeld = 0;
+        state.trap = trap;
+        return state;
+    }
+};
+
+// A ROM's boot run ahead of time: the state after `frames` frames of `cycles` instructions and
+// then `instructions - frames * cycles` more, stopping before the first instruction that reads
+// the keypad or the random generator (or at the frame limit, or on a trap).
+struct BakedBoot {
+    Chip8::State state = {};
+    uint32_t instructions = 0;
+    uint32_t frames = 0;
+    int cycles = 16;
+};
+
+// Instructions whose result isn't known until run time
+constexpr bool DependsOnHost(Instruction instruction) {
+    return instruction == Instruction::RND || instruction == Instruction::SKP || instruction == Instruction::SKNP ||
+        instruction == Instruction::LD_VX_K;
+}
+
+// Runs with the default quirks; constant-evaluable, so `constexpr auto boot = Bake(rom);` does the
+// work in the compiler
+constexpr BakedBoot Bake(std::span<const uint8_t> rom, int cycles = 16, int maxFrames = 600) {
+    BootMachine machine;
+    machine.Load(rom);
+
+    BakedBoot boot;
+    boot.cycles = cycles;
+    for (int frame = 0; frame < maxFrames; ++frame) {
+        for (int cycle = 0; cycle < cycles; ++cycle) {
+            if (machine.pc > 0xFFF || DependsOnHost(parse(machine.Fetch())) || machine.cpuState != Chip8::CpuState::Running) {
+                boot.state = machine.ToState();
+                return boot;
+            }
+            machine.Step();
+            boot.instructions++;
+        }
+        machine.TickTimer();
+        boot.frames++;
+    }
+    boot.state = machine.ToState();
+    return boot;
+}
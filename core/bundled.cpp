@@ -0,0 +1,55 @@
+#include "bundled.h"
+
+namespace {
+
+#if __has_include("bundled_roms.inc")
+// One array and one constexpr Bake() per ROM, evaluated during compilation
+#define BUNDLED_ROM(id, file, ...)                          \
+    constexpr uint8_t id##_bytes[] = { __VA_ARGS__ };       \
+    constexpr BakedBoot id##_boot = Bake(id##_bytes);
+#include "bundled_roms.inc"
+#undef BUNDLED_ROM
+
+#define BUNDLED_ROM(id, file, ...) BundledRom{ file, id##_bytes, &id##_boot },
+constexpr BundledRom kBundled[] = {
+#include "bundled_roms.inc"
+};
+#undef BUNDLED_ROM
+
+std::span<const BundledRom> bundled = kBundled;
+#else
+std::span<const BundledRom> bundled;
+#endif
+
+} // namespace
+
+std::span<const BundledRom> BundledRoms() {
+    return bundled;
+}
+
+const BundledRom* FindBundled(const RomImage& image) {
+    for (const BundledRom& entry : bundled) {
+        if (entry.rom.size() != image.size) continue;
+
+        bool same = true;
+        for (size_t i = 0; i < entry.rom.size() && same; ++i) {
+            same = entry.rom[i] == image[Chip8::kStartAddress + i];
+        }
+        if (same) return &entry;
+    }
+    return nullptr;
+}
+
+bool ApplyBakedBoot(Chip8& chip8) {
+    if (chip8.quirks != Quirks{}) return false;
+    const BundledRom* entry = FindBundled(chip8.Rom());
+    if (!entry || entry->boot->instructions == 0) return false;
+
+    Chip8::State state = entry->boot->state;
+    state.keypad = chip8.keypad;
+    state.rng = chip8.rand.save();
+    if (!chip8.LoadState(state)) return false;
+    chip8.counters.instructions += entry->boot->instructions;
+    chip8.counters.timerTicks += entry->boot->frames;
+    return true;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include "boot.h"
+#include "chip8.h"
+
+// ROMs compiled into the binary (CHIP8_BUNDLED_ROMS in CMakeLists.txt), each with its boot
+// pre-executed by the compiler so loading it starts where the program first waits on the host.
+struct BundledRom {
+    std::string_view file;
+    std::span<const uint8_t> rom;
+    const BakedBoot* boot;
+};
+
+// Empty when the build didn't generate bundled_roms.inc
+std::span<const BundledRom> BundledRoms();
+
+// The bundled ROM with the same program bytes as the image, nullptr if there is none
+const BundledRom* FindBundled(const RomImage& image);
+
+// Moves a freshly loaded instance to its ROM's baked boot, keeping its keypad and random stream.
+// Boots are baked with the default quirks, so nothing is applied under any other set. Returns
+// false if nothing was applied.
+bool ApplyBakedBoot(Chip8& chip8);
@@ -0,0 +1,106 @@
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "catalog.h"
+
+bool RomCatalog::Load(const std::filesystem::path& path) {
+    this->path = path;
+    entries.clear();
+
+    std::ifstream file(path);
+    if (!file.is_open()) return true;
+
+    std::string line;
+    int number = 0;
+    while (std::getline(file, line)) {
+        number++;
+        std::string title;
+        if (auto comment = line.find('#'); comment != std::string::npos) {
+            if (auto start = line.find_first_not_of(" #", comment); start != std::string::npos) {
+                title = line.substr(start);
+            }
+            line.resize(comment);
+        }
+
+        std::istringstream fields(line);
+        uint64_t hash;
+        if (!(fields >> std::hex >> hash)) {
+            if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+            std::cerr << path.string() << ":" << number << ": malformed catalog line" << std::endl;
+            return false;
+        }
+
+        Settings& settings = entries[hash];
+        settings.title = title;
+        for (std::string field; fields >> field;) {
+            auto equals = field.find('=');
+            std::string key = field.substr(0, equals);
+            std::string value = equals == std::string::npos ? "" : field.substr(equals + 1);
+            if (key == "runahead") {
+                settings.runAhead = std::atoi(value.c_str());
+            } else if (key == "quirks" && ParseProfile(value)) {
+                settings.quirks = ParseProfile(value);
+            } else {
+                settings.unknown += (settings.unknown.empty() ? "" : " ") + field;
+            }
+        }
+    }
+    return true;
+}
+
+bool RomCatalog::Save() const {
+    std::error_code error;
+    if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path(), error);
+
+    auto temporary = path;
+    temporary += ".tmp";
+    std::ofstream file(temporary);
+    if (!file.is_open()) {
+        std::cerr << "Unable to write ROM catalog: " << temporary.string() << std::endl;
+        return false;
+    }
+
+    file << "# hash  settings  # title\n";
+    for (const auto& [hash, settings] : entries) {
+        file << std::hex << std::setfill('0') << std::setw(16) << hash << std::dec;
+        file << " runahead=" << settings.runAhead;
+        if (settings.quirks) file << " quirks=" << ProfileName(*settings.quirks);
+        if (!settings.unknown.empty()) file << ' ' << settings.unknown;
+        if (!settings.title.empty()) file << "  # " << settings.title;
+        file << '\n';
+    }
+    file.close();
+    if (!file) {
+        std::cerr << "Unable to write ROM catalog: " << temporary.string() << std::endl;
+        return false;
+    }
+
+    // Replaces the old catalog in one step (POSIX rename and std::filesystem::rename both overwrite)
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::cerr << "Unable to replace ROM catalog: " << path.string() << ": " << error.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::filesystem::path RomCatalog::DefaultPath() {
+#if defined(_WIN32)
+    const char* config = std::getenv("APPDATA");
+    std::filesystem::path base = config && *config ? std::filesystem::path(config) : std::filesystem::path();
+#else
+    const char* config = std::getenv("XDG_CONFIG_HOME");
+    const char* home = std::getenv("HOME");
+    std::filesystem::path base = config && *config ? std::filesystem::path(config)
+        : home && *home ? std::filesystem::path(home) / ".config" : std::filesystem::path();
+#endif
+    if (base.empty()) return "chip8.catalog";
+    return base / "chip8" / "chip8.catalog";
+}
+
+const RomCatalog::Settings* RomCatalog::Find(uint64_t hash) const {
+    auto entry = entries.find(hash);
+    return entry == entries.end() ? nullptr : &entry->second;
+}
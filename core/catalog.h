@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include "quirks.h"
+
+// Per-ROM settings, keyed by the FNV-1a hash of the ROM bytes (HashRom) so renamed copies share
+// them. The file has one line per ROM:
+//   <hash> key=value ...  # title
+// Keys this build doesn't know are kept and written back unchanged.
+class RomCatalog {
+public:
+    struct Settings {
+        int runAhead = 0;                   // Frames presented ahead of the live machine, 0 = off
+        std::optional<Profile> quirks;      // Unset until classified or chosen
+        std::string title;
+        std::string unknown;                // Unrecognised key=value pairs, verbatim
+    };
+
+    // A missing file is an empty catalog, only malformed lines fail
+    bool Load(const std::filesystem::path& path);
+    // Writes a temporary file and renames it over the catalog, so a crash never loses the old one
+    bool Save() const;
+
+    // chip8/chip8.catalog in the user's configuration directory (%APPDATA%, $XDG_CONFIG_HOME or
+    // ~/.config), or the working directory if none can be found
+    static std::filesystem::path DefaultPath();
+
+    [[nodiscard]] const Settings* Find(uint64_t hash) const;
+    Settings& operator[](uint64_t hash) { return entries[hash]; }
+    [[nodiscard]] const std::filesystem::path& Path() const { return path; }
+
+private:
+    std::filesystem::path path;
+    std::map<uint64_t, Settings> entries;
+};
@@ -1,93 +1,256 @@
+#include <algorithm>
+#include <bit>
 #include <filesystem>
+#include <vector>
 #include "chip8.h"
 #include "opcode.h"
 #include "parser.h"
 #include "instructions.h"
 
-Chip8::Chip8(GLFWwindow* window) : window(window) {
+Chip8::Chip8() {
 	ResetChip8();
 }
 
 void Chip8::ResetChip8() {
-	memory.fill(0);
+    // Every instance boots from the same font-only image until a ROM is loaded
+    static const auto blank = CreateImage({});
+    memory.Attach(blank);
+    registers.fill(0);
+    stack.fill(0);
+    display.fill(0);
+    keypad.fill(0);
+    sp = 0;
+    index = 0;
+    delayTimer = 0;
+    soundTimer = 0;
+    opcode = 0;
+    cpuState = CpuState::Running;
+    waitRegister = 0;
+    waitKey = -1;
+    waitHeld = 0;
+    trap = Trap::None;
+    rand.reset();
+    redraw = true;
 	pc = kStartAddress;
-    std::copy(begin(kSprites), end(kSprites), begin(memory) + 0x50);
 }
 
 bool Chip8::LoadRom(std::string_view filename) {
-    std::cout << "Attempting to open ROM file at path: " << filename << std::endl;
+    std::cerr << "Attempting to open ROM file at path: " << filename << std::endl;
     std::ifstream file(filename.data(), std::ios::binary | std::ios::ate);
     if (!file.is_open()) {
         std::cerr << "Failed to open ROM file." << std::endl;
         return false;
     }
 
-    // ROM settings for GUI
-    romPath = std::filesystem::absolute(filename).string();
-    romTitle = std::filesystem::path(romPath).filename().string();
-    romSize = file.tellg();
-
-    if (romSize <= 0) {
+    auto fileSize = static_cast<std::streamoff>(file.tellg());
+    if (fileSize <= 0) {
         std::cerr << "ROM file is empty or read error occurred." << std::endl;
         return false;
     }
 
+    std::vector<uint8_t> rom(fileSize);
     file.seekg(0, std::ios::beg);
-    file.read(reinterpret_cast<char*>(&memory[kStartAddress]), romSize);
+    file.read(reinterpret_cast<char*>(rom.data()), fileSize);
     file.close();
-    std::cerr << "Loaded ROM size: " << romSize << " bytes." << std::endl;
+
+    if (rom.empty() || rom.size() > kMaxRomSize) {
+        std::cerr << "ROM size " << rom.size() << " is outside 1-" << kMaxRomSize << " bytes." << std::endl;
+        return false;
+    }
+
+    // ROM settings for GUI
+    auto path = std::filesystem::absolute(filename).string();
+    auto title = std::filesystem::path(path).filename().string();
+    LoadRom(CreateImage(rom, title, path));
+    std::cerr << "Loaded ROM size: " << rom.size() << " bytes." << std::endl;
     return true;
 }
 
-// Fetch-decode-execute cycle (fetch the opcode, decode the operation and execute the instruction)
+// Replaces memory with the font and the ROM at the start address. Silent, since libchip8 and
+// the batch tools load through it; a bad size is reported by the return value only.
+bool Chip8::LoadRom(std::span<const uint8_t> rom) {
+    if (rom.empty() || rom.size() > kMaxRomSize) return false;
+
+    LoadRom(CreateImage(rom));
+    return true;
+}
+
+void Chip8::LoadRom(std::shared_ptr<const RomImage> image) {
+    memory.Attach(std::move(image));
+}
+
+std::shared_ptr<const RomImage> Chip8::CreateImage(std::span<const uint8_t> rom, std::string title, std::string path) {
+    std::array<uint8_t, 4096> boot = { 0 };
+    std::copy(begin(kSprites), end(kSprites), begin(boot) + 0x50);
+    std::copy_n(rom.begin(), std::min(rom.size(), size_t(kMaxRomSize)), begin(boot) + kStartAddress);
+    return RomImage::Create(boot, rom.size(), std::move(title), std::move(path));
+}
+
 void Chip8::Tick() {
+    if (cpuState != CpuState::Running) [[unlikely]] {
+        if (Trapped() || !PollKeyWait()) return;
+    }
+
+    if (trace || debugger) [[unlikely]] {
+        if (debugger && debugger->BeforeExecute(*this)) return;
+
+        uint16_t address = pc;
+        Execute();
+        if (Trapped()) return;
+        counters.instructions++;
+        if (trace) trace->Record(address, opcode, registers, index);
+        return;
+    }
+
+    Execute();
+    if (Trapped()) [[unlikely]] return;
+    counters.instructions++;
+}
+
+// Runs up to `cycles` instructions from the pre-decoded memory pages, with superinstructions. The resulting state is
+// identical to calling Tick() the same number of times. Returns the number of instructions executed,
+// which is less than `cycles` only when an attached debugger stops, Fx0A starts waiting for a key
+// or an instruction traps.
+int Chip8::Run(int cycles) {
+    // A parked instance costs one poll of the keypad per call, a trapped one a single branch
+    if (cpuState != CpuState::Running) [[unlikely]] {
+        if (Trapped() || !PollKeyWait()) return 0;
+    }
+
+    if (debugger) [[unlikely]] {
+        if (debugger->Stopped()) return 0;
+        memory.SetBreakpoints(&debugger->Breakpoints(), debugger->BreakpointGeneration());
+    } else if (memory.Tagged()) [[unlikely]] {
+        memory.SetBreakpoints(nullptr, 0);
+    }
+
+    if (trace || (debugger && debugger->NeedsEveryInstruction())) [[unlikely]] {
+        // Instrumentation needs to see every instruction, so use the reference path
+        int executed = 0;
+        while (executed < cycles) {
+            Tick();
+            if (Trapped()) break;
+            if (debugger && debugger->Stopped()) {
+                // Watchpoints stop after their instruction, breakpoints and conditions before it
+                auto reason = debugger->Reason();
+                if (reason == Debugger::Stop::Read || reason == Debugger::Stop::Write) executed++;
+                break;
+            }
+            executed++;
+            if (Waiting()) break;
+        }
+        return executed;
+    }
+
+    int executed = 0;
+    while (executed < cycles) {
+        // Odd addresses are rare enough to decode uncached, and one test covers leaving memory too
+        if (pc & 0xF001) [[unlikely]] {
+            if (debugger && debugger->BeforeExecute(*this)) break;
+            Execute();
+            if (Trapped()) break;
+            executed++;
+            if (Waiting() || (debugger && debugger->Stopped())) break;
+            continue;
+        }
+
+        const DecodedOp& op = memory.Decoded(pc);
+        if (op.fused == Superinstruction::BREAK) [[unlikely]] {
+            // A breakpoint here or inside the fusion: the debugger decides, then one instruction runs
+            if (debugger && debugger->BeforeExecute(*this)) break;
+            Execute();
+            if (Trapped()) break;
+            executed++;
+            if (Waiting() || (debugger && debugger->Stopped())) break;
+            continue;
+        }
+        uint16_t raw = op.opcode;
+
+        opcode = raw;
+        pc += 2;
+
+        int budget = cycles - executed;
+        switch (op.fused) {
+            case Superinstruction::SKIP_JMP: executed += SKIP_JMP(raw, this, budget); break;
+            case Superinstruction::LD_VX_KK_CHAIN:
+                // No further than decoded, so a breakpoint past the chain's end is still seen
+                executed += LD_VX_KK_CHAIN(raw, this, std::min(budget, int(op.length)));
+                break;
+            case Superinstruction::LD_I_DRW:
+                executed += LD_I_DRW(raw, this, budget);
+                if (debugger && debugger->Stopped()) [[unlikely]] cycles = executed;
+                break;
+            case Superinstruction::ADD_SKIP: executed += ADD_SKIP(raw, this, budget); break;
+            case Superinstruction::KEY_WAIT:
+                // Fx0A is tagged at decode time so the fast path never checks for a wait
+                LD_VX_K(raw, this);
+                executed++;
+                cycles = executed;
+                break;
+            case Superinstruction::TRAPS:
+                // Only the instructions that can fault pay for the check
+                Dispatch(op.instruction);
+                if (Trapped()) [[unlikely]] {
+                    cycles = executed;
+                    break;
+                }
+                executed++;
+                // A watchpoint stops after the instruction that touched memory through I
+                if (debugger && debugger->Stopped()) [[unlikely]] cycles = executed;
+                break;
+            case Superinstruction::DRAW:
+                Dispatch(op.instruction);
+                executed++;
+                if (debugger && debugger->Stopped()) [[unlikely]] cycles = executed;
+                break;
+            default:
+                Dispatch(op.instruction);
+                executed++;
+                break;
+        }
+    }
+    counters.instructions += executed;
+    return executed;
+}
+
+// Fetch-decode-execute cycle (fetch the opcode, decode the operation and execute the instruction)
+void Chip8::Execute() {
+    if (pc > 0xFFF) [[unlikely]] {
+        Raise(Trap::OutOfRange, pc);
+        return;
+    }
+
 	opcode = memory[pc] << 8 | memory[pc + 1];
     auto instruction = parse(opcode);
 
 	pc += 2;
 
-    switch (instruction) {
-        case Instruction::CLS: return CLS(this);
-        case Instruction::RET: return RET(this);
-        case Instruction::JMP: return JMP(opcode, this);
-        case Instruction::CALL: return CALL(opcode, this);
-        case Instruction::SE_VX_KK: return SE_VX_KK(opcode, this);
-        case Instruction::SNE_VX_KK: return SNE_VX_KK(opcode, this);
-        case Instruction::SE_VX_VY: return SE_VX_VY(opcode, this);
-        case Instruction::LD_VX_KK: return LD_VX_KK(opcode, this);
-        case Instruction::ADD_VX_KK: return ADD_VX_KK(opcode, this);
-        case Instruction::LD_VX_VY: return LD_VX_VY(opcode, this);
-        case Instruction::OR_VX_VY: return OR_VX_VY(opcode, this);
-        case Instruction::AND_VX_VY: return AND_VX_VY(opcode, this);
-        case Instruction::XOR_VX_VY: return XOR_VX_VY(opcode, this);
-        case Instruction::ADD_VX_VY: return ADD_VX_VY(opcode, this);
-        case Instruction::SUB_VX_VY: return SUB_VX_VY(opcode, this);
-        case Instruction::SHR_VX: return SHR_VX(opcode, this);
-        case Instruction::SUBN_VX_VY: return SUBN_VX_VY(opcode, this);
-        case Instruction::SHL_VX: return SHL_VX(opcode, this);
-        case Instruction::SNE_VX_VY: return SNE_VX_VY(opcode, this);
-        case Instruction::LD_I: return LD_I(opcode, this);
-        case Instruction::JMP_V0: return JP_V0(opcode, this);
-        case Instruction::RND: return RND(opcode, this, &rand);
-        case Instruction::DRW: return DRW(opcode, this);
-        case Instruction::SKP: return SKP(opcode, this, window);
-        case Instruction::SKNP: return SKNP(opcode, this, window);
-        case Instruction::LD_VX_DT: return LD_VX_DT(opcode, this);
-        case Instruction::LD_VX_K: return LD_VX_K(opcode, this, window);
-        case Instruction::LD_DT: return LD_DT(opcode, this);
-        case Instruction::LD_ST: return LD_ST(opcode, this);
-        case Instruction::ADD_I_VX: return ADD_I_VX(opcode, this);
-        case Instruction::LD_F_VX: return LD_F_VX(opcode, this);
-        case Instruction::LD_B_VX: return LD_B_VX(opcode, this);
-        case Instruction::LD_I_VX: return LD_I_VX(opcode, this);
-        case Instruction::LD_VX_I: return LD_VX_I(opcode, this);
-
-        default:
-            break;
+    Dispatch(instruction);
+}
+
+void Chip8::Dispatch(Instruction instruction) {
+    ExecuteInstruction(this, instruction);
+}
+
+void Chip8::Raise(Trap trap, uint16_t address) {
+    this->trap = trap;
+    cpuState = CpuState::Trapped;
+    pc = address;
+}
+
+const char* Chip8::TrapName(Trap trap) {
+    switch (trap) {
+        case Trap::None: return "none";
+        case Trap::StackOverflow: return "stack overflow";
+        case Trap::StackUnderflow: return "stack underflow";
+        case Trap::InvalidOpcode: return "invalid opcode";
+        case Trap::OutOfRange: return "out of range";
     }
+    return "unknown";
 }
 
 void Chip8::TickTimer() {
+    counters.timerTicks++;
     if (delayTimer > 0) delayTimer--;   
     if (soundTimer > 0) {
         if (soundTimer == 1) {
@@ -98,10 +261,98 @@ void Chip8::TickTimer() {
     }
 }
 
-bool Chip8::IsPressed(GLFWwindow* window, uint8_t key) {
+// Runs one 60 Hz frame: the given number of instructions followed by a timer tick
+void Chip8::RunFrame(int cycles) {
+    Run(cycles);
+    TickTimer();
+}
+
+// The keypad is filled in by the host (GUI or headless runner) before ticking
+bool Chip8::IsPressed(uint8_t key) const {
     // Ensure the key index is valid
     if (key < 16) {  
-        return glfwGetKey(window, keymap[key]) == GLFW_PRESS;
+        return keypad[key];
     }
     return false;
+}
+
+namespace {
+
+uint16_t KeyMask(const std::array<uint8_t, 16>& keypad) {
+    uint16_t mask = 0;
+    for (int key = 0; key < 16; ++key) {
+        if (keypad[key]) mask |= 1 << key;
+    }
+    return mask;
+}
+
+} // namespace
+
+void Chip8::WaitForKey(uint8_t x) {
+    cpuState = CpuState::WaitingForKey;
+    waitRegister = x;
+    waitKey = -1;
+    // Keys already down when the wait starts must be released and pressed again
+    waitHeld = KeyMask(keypad);
+}
+
+// The keypad only changes between Tick/Run calls, so polling at their start sees every edge the host makes
+bool Chip8::PollKeyWait() {
+    uint16_t keys = KeyMask(keypad);
+    if (waitKey < 0) {
+        uint16_t pressed = keys & ~waitHeld;
+        if (pressed) waitKey = static_cast<int8_t>(std::countr_zero(pressed));
+    } else if (!(keys >> waitKey & 1)) {
+        registers[waitRegister] = static_cast<uint8_t>(waitKey);
+        cpuState = CpuState::Running;
+        waitKey = -1;
+        waitHeld = 0;
+        return true;
+    }
+    waitHeld = keys;
+    return false;
+}
+
+void Chip8::SaveState(State& state) const {
+    memory.CopyTo(state.memory);
+    state.registers = registers;
+    state.stack = stack;
+    state.display = display;
+    state.keypad = keypad;
+    state.sp = sp;
+    state.pc = pc;
+    state.index = index;
+    state.delayTimer = delayTimer;
+    state.soundTimer = soundTimer;
+    state.opcode = opcode;
+    state.cpuState = cpuState;
+    state.waitRegister = waitRegister;
+    state.waitKey = waitKey;
+    state.waitHeld = waitHeld;
+    state.trap = trap;
+    state.rng = rand.save();
+}
+
+bool Chip8::LoadState(const State& state) {
+    if (!ValidState(state)) return false;
+
+    memory.Assign(state.memory);
+    registers = state.registers;
+    stack = state.stack;
+    display = state.display;
+    keypad = state.keypad;
+    sp = state.sp;
+    pc = state.pc;
+    index = state.index;
+    delayTimer = state.delayTimer;
+    soundTimer = state.soundTimer;
+    opcode = state.opcode;
+    cpuState = state.cpuState;
+    waitRegister = state.waitRegister;
+    waitKey = state.waitKey;
+    waitHeld = state.waitHeld;
+    trap = state.trap;
+    rand.restore(state.rng);
+    redraw = true;
+    return true;
 }
\ No newline at end of file
@@ -1,27 +1,81 @@
 #pragma once
 
 #include <array>
+#include <memory>
+#include <span>
+#include <string>
 #include <string_view>
 #include <fstream>
 #include <iostream>
+#include "debugger.h"
+#include "fusion.h"
+#include "memory.h"
+#include "quirks.h"
 #include "random.h"
-#include "graphics.h"
+#include "trace.h"
 
 class Chip8 {
 public:
-    Chip8(GLFWwindow* window);
+    struct State;
+
+    // Fx0A parks the CPU until a key is pressed and released; Tick and Run execute nothing while
+    // it waits, but the timers keep counting down. A trap halts it until the next reset or load.
+    enum class CpuState : uint8_t { Running, WaitingForKey, Trapped };
+
+    // Faults that halt this instance instead of the process. The faulting instruction is not
+    // executed: pc is left at its address and opcode holds it. For a fetch past 0xFFF, pc is that
+    // address and opcode the instruction that got there.
+    enum class Trap : uint8_t {
+        None,
+        StackOverflow,      // 2nnn with all 16 entries in use
+        StackUnderflow,     // 00EE with an empty stack
+        InvalidOpcode,      // Anything parse() doesn't know, including 0nnn
+        OutOfRange,         // pc past 0xFFF, or Fx33/Fx55/Fx65 reaching past it from I
+    };
+
+    // Cumulative totals for metrics. Plain integers, bumped on the hot path without atomics;
+    // hosts publish them through InstanceMetrics::Collect().
+    struct Counters {
+        uint64_t instructions = 0;
+        uint64_t draws = 0;
+        uint64_t timerTicks = 0;
+    };
+
+    Chip8();
 
     void ResetChip8();
     bool LoadRom(std::string_view filename);
+    bool LoadRom(std::span<const uint8_t> rom);
+    // Shares an already loaded image, e.g. to boot many instances of one ROM
+    void LoadRom(std::shared_ptr<const RomImage> image);
+    [[nodiscard]] const RomImage& Rom() const { return *memory.Image(); }
+    // Builds the boot image (font + program) for a ROM without loading it into an instance
+    static std::shared_ptr<const RomImage> CreateImage(std::span<const uint8_t> rom, std::string title = "N/A", std::string path = "N/A");
     void Tick();
+    int Run(int cycles);
     void TickTimer();
-    bool IsPressed(GLFWwindow* window, uint8_t key);
+    void RunFrame(int cycles);
+    bool IsPressed(uint8_t key) const;
+    [[nodiscard]] bool Waiting() const { return cpuState == CpuState::WaitingForKey; }
+    // Starts waiting for a key for Fx0A, the key goes into register x once released
+    void WaitForKey(uint8_t x);
+    [[nodiscard]] bool Trapped() const { return cpuState == CpuState::Trapped; }
+    // Halts with the trap, pc set to the faulting address. Called by the instruction handlers.
+    void Raise(Trap trap, uint16_t address);
+    static const char* TrapName(Trap trap);
+    void SaveState(State& state) const;
+    // Leaves the instance untouched and returns false if the state fails ValidState()
+    bool LoadState(const State& state);
+    // True if every index and enum in the state is in range and the generator isn't stuck at zero,
+    // so a blob from outside can be loaded
+    static constexpr bool ValidState(const State& state);
 
     static constexpr int kWindowWidth = 1280;
     static constexpr int kWindowHeight = 720;
     static constexpr int kWidth = 64;
     static constexpr int kHeight = 32;
     static constexpr int kStartAddress = 0x200;    
+    static constexpr int kMaxRomSize = 4096 - kStartAddress;
     static constexpr std::array<uint8_t, 80> kSprites {
         // Sprites 0-F
         0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
@@ -42,24 +96,13 @@ public:
         0xF0, 0x80, 0xF0, 0x80, 0x80  // F
     };
 
-    GLFWwindow* window = nullptr;
-
-    std::array<GLuint, 16> keymap = {
-        GLFW_KEY_X,                         // |       | X (0) |       |       |
-        GLFW_KEY_1, GLFW_KEY_2, GLFW_KEY_3, // | 1 (1) | 2 (2) | 3 (3) |       |
-        GLFW_KEY_Q, GLFW_KEY_W, GLFW_KEY_E, // | Q (4) | W (5) | E (6) |       |
-        GLFW_KEY_A, GLFW_KEY_S, GLFW_KEY_D, // | A (7) | S (8) | D (9) |       |
-        GLFW_KEY_Z, GLFW_KEY_C,             // | Z (A) |       | C (B) |       |
-        GLFW_KEY_4,                         // |       |       |       | 4 (C) |
-        GLFW_KEY_R,                         // |       |       |       | R (D) |
-        GLFW_KEY_F,                         // |       |       |       | F (E) |
-        GLFW_KEY_V,                         // |       |       |       | V (F) |
-    };
+    // One byte per pixel (0 or 1), row-major
+    using Display = std::array<uint8_t, kWidth * kHeight>;
 
-    std::array<uint8_t, 4096> memory = { 0 };
+    Memory memory;
     std::array<uint8_t, 16> registers = { 0 };
     std::array<uint16_t, 16> stack = { 0 };
-    std::array<uint16_t, kWidth* kHeight> display = { 0 };
+    Display display = { 0 };
     std::array<uint8_t, 16> keypad = { 0 };
 
     uint8_t sp = 0;
@@ -69,24 +112,63 @@ public:
     uint8_t soundTimer = 0;
     uint16_t opcode = 0;
 
+    CpuState cpuState = CpuState::Running;
+    // Fx0A bookkeeping: the destination register, the keys down at the last poll and the key
+    // pressed since the wait began (-1 for none yet)
+    uint8_t waitRegister = 0;
+    int8_t waitKey = -1;
+    uint16_t waitHeld = 0;
+    Trap trap = Trap::None;
+
     bool beep = false;
     bool redraw = false;
 
-    // ROM GUI variables
-    std::string romTitle = "N/A";
-    std::string romPath = "N/A";
-    int romSize = 0;
-
     Random rand;
+    Counters counters;
+    // Configuration rather than state: kept across resets and loads, not part of save states
+    Quirks quirks;
+
+    // Optional instrumentation, both nullptr by default. Tick takes a single predictable branch while they are unset.
+    TraceRecorder* trace = nullptr;
+    Debugger* debugger = nullptr;
+
+private:
+    // Advances a pending Fx0A wait from the keypad, true once the CPU runs again
+    bool PollKeyWait();
+    void Execute();
+    void Dispatch(Instruction instruction);
+};
+
+// Snapshot of everything the running program can observe, used for save states
+struct Chip8::State {
+    std::array<uint8_t, 4096> memory;
+    std::array<uint8_t, 16> registers;
+    std::array<uint16_t, 16> stack;
+    Display display;
+    std::array<uint8_t, 16> keypad;
+
+    uint8_t sp;
+    uint16_t pc;
+    uint16_t index;
+    uint8_t delayTimer;
+    uint8_t soundTimer;
+    uint16_t opcode;
+    CpuState cpuState;
+    uint8_t waitRegister;
+    int8_t waitKey;
+    uint16_t waitHeld;
+    Trap trap;
+    Random::State rng;
 };
 
-/*
-    ------------------------------------------------
-    |   Chip 8 Keyboard    |     Keyboard Map      |
-    ------------------------------------------------
-    |   1    2    3    C   |    1    2    3    4   |
-    |   4    5    6    D   |    Q    W    E    R   |
-    |   7    8    9    E   |    A    S    D    F   |
-    |   A    0    B    F   |    Z    X    C    V   |
-    ------------------------------------------------
-*/
\ No newline at end of file
+constexpr bool Chip8::ValidState(const State& state) {
+    if (state.sp > state.stack.size() || state.waitRegister > 0x0F) return false;
+    if (state.waitKey < -1 || state.waitKey > 0x0F) return false;
+    if (state.cpuState > CpuState::Trapped || state.trap > Trap::OutOfRange) return false;
+    if ((state.cpuState == CpuState::Trapped) != (state.trap != Trap::None)) return false;
+    for (uint8_t pixel : state.display) {
+        if (pixel > 1) return false;
+    }
+    // xoshiro128** never leaves the all-zero state, every later Cxkk would return 0
+    return state.rng != Random::State{};
+}
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <bitset>
+#include <thread>
+#include <unordered_set>
+#include "classifier.h"
+#include "hash.h"
+
+Platform OpcodeScan::Required() const {
+    if (platforms[static_cast<int>(Platform::XoChip)] > 0) return Platform::XoChip;
+    if (platforms[static_cast<int>(Platform::SuperChip)] > 0) return Platform::SuperChip;
+    return Platform::Chip8;
+}
+
+OpcodeScan ScanRom(const RomImage& image) {
+    OpcodeScan scan;
+    std::bitset<4096> visited;
+    std::vector<uint16_t> pending = { Chip8::kStartAddress };
+    const size_t end = Chip8::kStartAddress + image.size;
+
+    auto follow = [&](int address) {
+        if (address >= Chip8::kStartAddress && address + 1 < int(end) && !visited[address]) pending.push_back(uint16_t(address));
+    };
+
+    while (!pending.empty()) {
+        uint16_t address = pending.back();
+        pending.pop_back();
+        if (visited[address]) continue;
+        visited[address] = true;
+
+        Opcode opcode = uint16_t(image[address] << 8 | image[address + 1]);
+        Instruction instruction = parse(opcode);
+        scan.reachable++;
+        if (instruction == Instruction::UNKNOWN) {
+            scan.unknown++;
+            continue;
+        }
+        // 5xy2/5xy3 are also the lax 5xy0 of older ROMs, so they don't prove XO-CHIP on their own
+        bool lax = instruction == Instruction::SAVE_VX_VY || instruction == Instruction::LOAD_VX_VY;
+        scan.platforms[static_cast<int>(lax ? Platform::Chip8 : PlatformOf(instruction))]++;
+
+        switch (instruction) {
+        case Instruction::JMP:
+            follow(opcode.address());
+            break;
+        case Instruction::CALL:
+            follow(opcode.address());
+            follow(address + 2);
+            break;
+        case Instruction::RET:
+        case Instruction::EXIT:
+        case Instruction::JMP_V0:
+            break;
+        case Instruction::SE_VX_KK:
+        case Instruction::SNE_VX_KK:
+        case Instruction::SE_VX_VY:
+        case Instruction::SNE_VX_VY:
+        case Instruction::SKP:
+        case Instruction::SKNP:
+            // XO-CHIP skips jump over the whole 4-byte F000 nnnn
+            follow(address + 2);
+            follow(address + 4);
+            if (address + 3 < int(end) && image[address + 2] == 0xF0 && image[address + 3] == 0x00) follow(address + 6);
+            break;
+        case Instruction::LD_I_LONG:
+            follow(address + 4);
+            break;
+        default:
+            follow(address + 2);
+            break;
+        }
+    }
+    return scan;
+}
+
+namespace {
+
+ProfileRun RunProfile(const std::shared_ptr<const RomImage>& image, Profile profile, const ClassifierOptions& options) {
+    ProfileRun run;
+    run.profile = profile;
+
+    Chip8 chip8;
+    chip8.LoadRom(image);
+    chip8.quirks = QuirksFor(profile);
+    chip8.rand.seed(options.seed);
+
+    // The same taps for every profile: a random key held for 6 frames twice a second
+    Random taps;
+    taps.seed(options.seed, 1);
+    std::unordered_set<uint64_t> frames;
+    for (long long frame = 0; frame < options.frames; ++frame) {
+        if (frame % 30 == 0 || frame % 30 == 6) {
+            chip8.keypad.fill(0);
+            if (frame % 30 == 0) chip8.keypad[taps() & 0x0F] = 1;
+        }
+        chip8.RunFrame(options.cycles);
+        if (chip8.Trapped()) {
+            run.trap = chip8.trap;
+            run.trapFrame = frame;
+            break;
+        }
+
+        int lit = static_cast<int>(std::count(chip8.display.begin(), chip8.display.end(), 1));
+        if (frame >= 60 && lit == 0) run.blankFrames++;
+        if (lit > Chip8::kWidth * Chip8::kHeight / 2) run.noisyFrames++;
+        if (frames.size() < 1000) frames.insert(HashDisplay(chip8.display));
+    }
+    run.distinctFrames = static_cast<int>(frames.size());
+    return run;
+}
+
+Platform PlatformFor(Profile profile) {
+    switch (profile) {
+    case Profile::SuperChip: return Platform::SuperChip;
+    case Profile::XoChip: return Platform::XoChip;
+    default: return Platform::Chip8;
+    }
+}
+
+} // namespace
+
+Classification Classify(std::shared_ptr<const RomImage> image, const ClassifierOptions& options) {
+    Classification result;
+    result.scan = ScanRom(*image);
+    result.runs.resize(kProfiles.size());
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < kProfiles.size(); ++i) {
+        threads.emplace_back([&, i] { result.runs[i] = RunProfile(image, kProfiles[i], options); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    double frames = std::max(1, options.frames);
+    double best = 0.0;
+    for (size_t i = 0; i < result.runs.size(); ++i) {
+        ProfileRun& run = result.runs[i];
+        if (run.trap != Chip8::Trap::None) {
+            run.score -= 50.0 + 50.0 * (1.0 - run.trapFrame / frames);
+        }
+        run.score -= 20.0 * run.noisyFrames / frames;
+        run.score -= 10.0 * run.blankFrames / frames;
+        run.score += std::min(run.distinctFrames, 100) / 20.0;
+        if (PlatformFor(run.profile) == result.scan.Required()) run.score += 5.0;
+
+        if (i == 0 || run.score > best) {
+            best = run.score;
+            result.profile = run.profile;
+        }
+    }
+    return result;
+}
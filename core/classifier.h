@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+#include "chip8.h"
+#include "parser.h"
+#include "quirks.h"
+
+// Reachable instructions of a ROM by platform. The scan follows control flow from the start
+// address (both sides of skips, calls and their return sites), so data between routines is never
+// mistaken for code. Bnnn targets can't be known statically and end the path.
+struct OpcodeScan {
+    std::array<int, 3> platforms = { 0 };   // Indexed by Platform
+    int reachable = 0;
+    int unknown = 0;
+
+    // Newest platform with any reachable instruction
+    [[nodiscard]] Platform Required() const;
+};
+
+OpcodeScan ScanRom(const RomImage& image);
+
+// One run of the ROM under a profile, and what the classifier made of it
+struct ProfileRun {
+    Profile profile = Profile::Default;
+    double score = 0.0;
+    Chip8::Trap trap = Chip8::Trap::None;
+    long long trapFrame = -1;
+    int blankFrames = 0;                    // After the first second
+    int noisyFrames = 0;                    // More than half the pixels lit
+    int distinctFrames = 0;
+};
+
+struct Classification {
+    Profile profile = Profile::Default;
+    OpcodeScan scan;
+    std::vector<ProfileRun> runs;           // In kProfiles order
+};
+
+struct ClassifierOptions {
+    int frames = 600;                       // 10 s of emulated time per profile
+    int cycles = 16;
+    uint64_t seed = 0;
+};
+
+// Scans the ROM, then runs it under every profile on its own thread with scripted key taps and
+// scores each run: traps cost the most (earlier is worse), then blank or noisy frames; a little
+// credit goes to display activity and to profiles of the platform the scan found. Ties keep the
+// earlier profile in kProfiles, so Default wins when the quirks make no visible difference.
+Classification Classify(std::shared_ptr<const RomImage> image, const ClassifierOptions& options = {});
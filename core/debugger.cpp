@@ -0,0 +1,61 @@
+#include "chip8.h"
+#include "debugger.h"
+
+bool Debugger::BeforeExecute(const Chip8& chip8) {
+    if (stop != Stop::None) return true;
+
+    if (skipOnce) {
+        skipOnce = false;
+        if (chip8.pc == skipAddress) return false;
+    }
+
+    if (breakpoints.test(chip8.pc & 0xFFF)) {
+        stop = Stop::Breakpoint;
+        stopAddress = chip8.pc;
+        return true;
+    }
+
+    bool hit = false;
+    for (auto& condition : conditions) {
+        uint16_t current = condition.reg == kIndex ? chip8.index : chip8.registers[condition.reg & 0x0F];
+        bool matches = current == condition.value;
+        hit |= matches && !condition.matched;
+        condition.matched = matches;
+    }
+    if (hit) {
+        stop = Stop::Condition;
+        stopAddress = chip8.pc;
+        return true;
+    }
+
+    return false;
+}
+
+void Debugger::Resume(uint16_t pc) {
+    stop = Stop::None;
+    skipOnce = true;
+    skipAddress = pc;
+}
+
+const char* Debugger::Describe(Stop reason) {
+    switch (reason) {
+    case Stop::Breakpoint: return "breakpoint";
+    case Stop::Condition: return "condition";
+    case Stop::Read: return "read watchpoint";
+    case Stop::Write: return "write watchpoint";
+    default: return "none";
+    }
+}
+
+void Debugger::Hit(Stop reason, uint16_t address, int length) {
+    if (stop != Stop::None) return;
+
+    const auto& watch = reason == Stop::Read ? readWatch : writeWatch;
+    for (int i = 0; i < length; ++i) {
+        if (watch.test((address + i) & 0xFFF)) {
+            stopAddress = (address + i) & 0xFFF;
+            break;
+        }
+    }
+    stop = reason;
+}
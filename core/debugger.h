@@ -0,0 +1,93 @@
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+#include <vector>
+
+class Chip8;
+
+// Execution breakpoints, register/I conditions and memory watchpoints for one Chip8.
+//
+// The emulator only consults a Debugger through Chip8::debugger, which hosts leave null while
+// nothing is set (see Armed()). A running instance with no debugger attached pays nothing.
+// Breakpoints and conditions stop before the instruction executes, watchpoints stop after the
+// instruction that touched the watched byte. Breakpoints and watchpoints leave Chip8::Run on the
+// fused engine: breakpoints are tagged in the decoded ops, and Run checks for a watchpoint stop
+// after the ops that access memory through I. Only conditions need every instruction.
+class Debugger {
+public:
+    enum class Stop { None, Breakpoint, Condition, Read, Write };
+
+    // Stops when the register becomes equal to value; reg 0-15 is V0-VF, kIndex is I
+    struct Condition {
+        int reg = 0;
+        uint16_t value = 0;
+        bool matched = false;
+    };
+    static constexpr int kIndex = 16;
+
+    std::bitset<4096> readWatch;
+    std::bitset<4096> writeWatch;
+    std::vector<Condition> conditions;
+
+    [[nodiscard]] const std::bitset<4096>& Breakpoints() const { return breakpoints; }
+    // Changes with every edit of the breakpoints, so Memory only re-tags its decoded ops when they change
+    [[nodiscard]] uint64_t BreakpointGeneration() const { return breakpointGeneration; }
+
+    void ToggleBreakpoint(uint16_t address) {
+        breakpoints.flip(address & 0xFFF);
+        breakpointGeneration++;
+    }
+
+    void ClearBreakpoints() {
+        breakpoints.reset();
+        breakpointGeneration++;
+    }
+
+    [[nodiscard]] bool Armed() const {
+        return breakpoints.any() || readWatch.any() || writeWatch.any() || !conditions.empty();
+    }
+
+    // True when Run has to go through Tick() one instruction at a time
+    [[nodiscard]] bool NeedsEveryInstruction() const {
+        return !conditions.empty();
+    }
+
+    // Called with pc pointing at the next instruction; true means do not execute it
+    bool BeforeExecute(const Chip8& chip8);
+
+    void OnRead(uint16_t address, int length) {
+        if (Watched(readWatch, address, length)) Hit(Stop::Read, address, length);
+    }
+
+    void OnWrite(uint16_t address, int length) {
+        if (Watched(writeWatch, address, length)) Hit(Stop::Write, address, length);
+    }
+
+    [[nodiscard]] bool Stopped() const { return stop != Stop::None; }
+    [[nodiscard]] Stop Reason() const { return stop; }
+    [[nodiscard]] uint16_t StopAddress() const { return stopAddress; }
+
+    // Clears the stop; the instruction at pc runs once without re-triggering its breakpoint
+    void Resume(uint16_t pc);
+
+    static const char* Describe(Stop reason);
+
+private:
+    static bool Watched(const std::bitset<4096>& watch, uint16_t address, int length) {
+        for (int i = 0; i < length; ++i) {
+            if (watch.test((address + i) & 0xFFF)) return true;
+        }
+        return false;
+    }
+
+    void Hit(Stop reason, uint16_t address, int length);
+
+    std::bitset<4096> breakpoints;
+    uint64_t breakpointGeneration = 1;
+
+    Stop stop = Stop::None;
+    uint16_t stopAddress = 0;
+    bool skipOnce = false;
+    uint16_t skipAddress = 0;
+};
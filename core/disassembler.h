@@ -0,0 +1,171 @@
+#pragma once
+
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include "parser.h"
+
+// Formats an opcode as assembly (e.g. "LD V3, 0a"), shared by the GUI and the trace tools
+inline std::string Disassemble(uint16_t opcode) {
+    std::stringstream ss;
+    ss << std::hex << std::setfill('0');
+    Instruction instr = parse(Opcode(opcode));
+
+    switch (instr) {
+    case Instruction::CLS:
+        ss << "CLS";
+        break;
+    case Instruction::RET:
+        ss << "RET";
+        break;
+    case Instruction::JMP:
+        ss << "JP " << std::setw(4) << (opcode & 0x0FFF);
+        break;
+    case Instruction::CALL:
+        ss << "CALL " << std::setw(4) << (opcode & 0x0FFF);
+        break;
+    case Instruction::SE_VX_KK:
+        ss << "SE V" << ((opcode & 0x0F00) >> 8) << ", " << std::setw(2) << std::setfill('0') << (opcode & 0x00FF);
+        break;
+    case Instruction::SNE_VX_KK:
+        ss << "SNE V" << ((opcode & 0x0F00) >> 8) << ", " << std::setw(2) << std::setfill('0') << (opcode & 0x00FF);
+        break;
+    case Instruction::SE_VX_VY:
+        ss << "SE V" << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4);
+        break;
+    case Instruction::LD_VX_KK:
+        ss << "LD V" << ((opcode & 0x0F00) >> 8) << ", " << std::setw(2) << std::setfill('0') << (opcode & 0x00FF);
+        break;
+    case Instruction::ADD_VX_KK:
+        ss << "ADD V" << ((opcode & 0x0F00) >> 8) << ", " << std::setw(2) << std::setfill('0') << (opcode & 0x00FF);
+        break;
+    case Instruction::LD_VX_VY:
+        ss << "LD V" << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4);
+        break;
+    case Instruction::OR_VX_VY:
+        ss << "OR V" << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4);
+        break;
+    case Instruction::AND_VX_VY:
+        ss << "AND V" << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4);
+        break;
+    case Instruction::XOR_VX_VY:
+        ss << "XOR V" << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4);
+        break;
+    case Instruction::ADD_VX_VY:
+        ss << "ADD V" << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4);
+        break;
+    case Instruction::SUB_VX_VY:
+        ss << "SUB V" << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4);
+        break;
+    case Instruction::SHR_VX:
+        ss << "SHR V" << ((opcode & 0x0F00) >> 8);
+        break;
+    case Instruction::SUBN_VX_VY:
+        ss << "SUBN V" << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4);
+        break;
+    case Instruction::SHL_VX:
+        ss << "SHL V" << ((opcode & 0x0F00) >> 8);
+        break;
+    case Instruction::SNE_VX_VY:
+        ss << "SNE V" << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4);
+        break;
+    case Instruction::LD_I:
+        ss << "LD I, " << std::setw(4) << (opcode & 0x0FFF);
+        break;
+    case Instruction::JMP_V0:
+        ss << "JP V0, " << std::setw(4) << (opcode & 0x0FFF);
+        break;
+    case Instruction::RND:
+        ss << "RND V" << ((opcode & 0x0F00) >> 8) << ", " << std::setw(2) << std::setfill('0') << (opcode & 0x00FF);
+        break;
+    case Instruction::DRW:
+        ss << "DRW V" << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4) << ", " << (opcode & 0x000F);
+        break;
+    case Instruction::SKP:
+        ss << "SKP V" << ((opcode & 0x0F00) >> 8);
+        break;
+    case Instruction::SKNP:
+        ss << "SKNP V" << ((opcode & 0x0F00) >> 8);
+        break;
+    case Instruction::LD_VX_DT:
+        ss << "LD V" << ((opcode & 0x0F00) >> 8) << ", DT";
+        break;
+    case Instruction::LD_VX_K:
+        ss << "LD V" << ((opcode & 0x0F00) >> 8) << ", K";
+        break;
+    case Instruction::LD_DT:
+        ss << "LD DT, V" << ((opcode & 0x0F00) >> 8);
+        break;
+    case Instruction::LD_ST:
+        ss << "LD ST, V" << ((opcode & 0x0F00) >> 8);
+        break;
+    case Instruction::ADD_I_VX:
+        ss << "ADD I, V" << ((opcode & 0x0F00) >> 8);
+        break;
+    case Instruction::LD_F_VX:
+        ss << "LD F, V" << ((opcode & 0x0F00) >> 8);
+        break;
+    case Instruction::LD_B_VX:
+        ss << "LD B, V" << ((opcode & 0x0F00) >> 8);
+        break;
+    case Instruction::LD_I_VX:
+        ss << "LD [I], V" << ((opcode & 0x0F00) >> 8);
+        break;
+    case Instruction::LD_VX_I:
+        ss << "LD V" << ((opcode & 0x0F00) >> 8) << ", [I]";
+        break;
+    case Instruction::SCD:
+        ss << "SCD " << (opcode & 0x000F);
+        break;
+    case Instruction::SCU:
+        ss << "SCU " << (opcode & 0x000F);
+        break;
+    case Instruction::SCR:
+        ss << "SCR";
+        break;
+    case Instruction::SCL:
+        ss << "SCL";
+        break;
+    case Instruction::EXIT:
+        ss << "EXIT";
+        break;
+    case Instruction::LOW:
+        ss << "LOW";
+        break;
+    case Instruction::HIGH:
+        ss << "HIGH";
+        break;
+    case Instruction::SAVE_VX_VY:
+        ss << "SAVE V" << ((opcode & 0x0F00) >> 8) << " - V" << ((opcode & 0x00F0) >> 4);
+        break;
+    case Instruction::LOAD_VX_VY:
+        ss << "LOAD V" << ((opcode & 0x0F00) >> 8) << " - V" << ((opcode & 0x00F0) >> 4);
+        break;
+    case Instruction::LD_I_LONG:
+        ss << "LD I, LONG";
+        break;
+    case Instruction::PLANE:
+        ss << "PLANE " << ((opcode & 0x0F00) >> 8);
+        break;
+    case Instruction::AUDIO:
+        ss << "AUDIO";
+        break;
+    case Instruction::LD_HF_VX:
+        ss << "LD HF, V" << ((opcode & 0x0F00) >> 8);
+        break;
+    case Instruction::PITCH:
+        ss << "PITCH V" << ((opcode & 0x0F00) >> 8);
+        break;
+    case Instruction::LD_R_VX:
+        ss << "LD R, V" << ((opcode & 0x0F00) >> 8);
+        break;
+    case Instruction::LD_VX_R:
+        ss << "LD V" << ((opcode & 0x0F00) >> 8) << ", R";
+        break;
+    default:
+        ss << "Unknown Opcode: " << std::setw(4) << opcode;
+        break;
+    }
+
+    return ss.str();
+}
\ No newline at end of file
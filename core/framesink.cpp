@@ -0,0 +1,144 @@
+#include <cstring>
+#include <iostream>
+#include "framesink.h"
+
+FrameSink::~FrameSink() {
+    Close();
+}
+
+bool FrameSink::Open(std::string_view path, Format format, int fps, bool collapseRepeats) {
+    Close();
+
+    if (path == "-") {
+        file = stdout;
+        ownsFile = false;
+    } else {
+        file = std::fopen(std::string(path).c_str(), "wb");
+        ownsFile = true;
+        if (!file) {
+            std::cerr << "Failed to open recording output: " << path << std::endl;
+            return false;
+        }
+    }
+
+    // Batching is done in our own buffer, stdio only ever sees whole blocks
+    std::setvbuf(file, nullptr, _IONBF, 0);
+
+    this->format = format;
+    collapse = collapseRepeats;
+    failed = false;
+    buffer.resize(kBufferSize);
+    frame.resize(kMaxFrame);
+    used = 0;
+    repeat = 0;
+    framesSubmitted = 0;
+    framesEncoded = 0;
+    framesWritten = 0;
+
+    if (format == Format::Y4M) {
+        char header[64];
+        int size = std::snprintf(header, sizeof(header), "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 Cmono\n", Chip8::kWidth, Chip8::kHeight, fps);
+        Append(header, size);
+    }
+
+    return true;
+}
+
+void FrameSink::Submit(const Chip8::Display& display) {
+    if (!file || failed) return;
+    framesSubmitted++;
+
+    if (repeat > 0 && std::memcmp(pending.data(), display.data(), sizeof(pending)) == 0) {
+        repeat++;
+        return;
+    }
+
+    EncodePending();
+    pending = display;
+    repeat = 1;
+}
+
+bool FrameSink::Close() {
+    if (!file) return !failed;
+
+    EncodePending();
+    Flush();
+
+    if (ownsFile && std::fclose(file) != 0 && !failed) {
+        std::cerr << "Recording write failed on close." << std::endl;
+        failed = true;
+    }
+    file = nullptr;
+    buffer.clear();
+    buffer.shrink_to_fit();
+    frame.clear();
+    frame.shrink_to_fit();
+    return !failed;
+}
+
+FrameSink::Format FrameSink::FormatFromPath(std::string_view path) {
+    return path.ends_with(".pbm") ? Format::PBM : Format::Y4M;
+}
+
+// Encodes the pending frame into `frame` and writes it once per repeat, or once with its repeat
+// count when collapsing
+void FrameSink::EncodePending() {
+    if (repeat == 0 || failed) return;
+
+    uint32_t count = collapse ? repeat : 1;
+    char* header = reinterpret_cast<char*>(frame.data());
+    int size = 0;
+    if (format == Format::Y4M) {
+        size = count > 1 ? std::snprintf(header, 64, "FRAME XREPEAT=%u\n", count)
+                         : std::snprintf(header, 64, "FRAME\n");
+    } else {
+        size = count > 1 ? std::snprintf(header, 64, "P4\n# repeat %u\n%d %d\n", count, Chip8::kWidth, Chip8::kHeight)
+                         : std::snprintf(header, 64, "P4\n%d %d\n", Chip8::kWidth, Chip8::kHeight);
+    }
+
+    constexpr size_t kPixels = Chip8::kWidth * Chip8::kHeight;
+    uint8_t* out = frame.data() + size;
+    size_t payload = format == Format::Y4M ? kPixels : kPixels / 8;
+    if (format == Format::Y4M) {
+        // Full-range luma: lit pixels white, unlit black
+        for (size_t i = 0; i < kPixels; ++i) {
+            out[i] = pending[i] ? 0xFF : 0x00;
+        }
+    } else {
+        // P4 packs 8 pixels per byte, MSB first, 1 = black ink
+        for (size_t i = 0; i < kPixels / 8; ++i) {
+            uint8_t packed = 0;
+            for (int bit = 0; bit < 8; ++bit) {
+                packed |= (pending[i * 8 + bit] ? 0x80 : 0x00) >> bit;
+            }
+            out[i] = packed;
+        }
+    }
+    framesEncoded++;
+
+    for (uint32_t copy = collapse ? 1 : repeat; copy > 0 && !failed; --copy) {
+        Append(header, size + payload);
+        if (!failed) framesWritten += count;
+    }
+    repeat = 0;
+}
+
+// The file stays open after a failed write, Close() releases it
+void FrameSink::Flush() {
+    if (failed) return;
+    if (used > 0 && std::fwrite(buffer.data(), 1, used, file) != used) {
+        std::cerr << "Recording write failed, stopping." << std::endl;
+        failed = true;
+    }
+    used = 0;
+}
+
+void FrameSink::Append(const char* data, size_t size) {
+    if (failed) return;
+    if (used + size > buffer.size()) {
+        Flush();
+        if (failed) return;
+    }
+    std::memcpy(buffer.data() + used, data, size);
+    used += size;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+#include <vector>
+#include "chip8.h"
+
+// Streams the Chip-8 display to a raw video file or pipe ("-" writes to stdout).
+//
+//   Y4M: "YUV4MPEG2 W64 H32 F60:1 Ip A1:1 Cmono" followed by 8-bit luma frames (ffmpeg, mpv).
+//   PBM: concatenated binary P4 images, 1 bit per pixel (netpbm, ffmpeg image2pipe).
+//
+// Identical consecutive frames are encoded once and that frame is written again for each repeat.
+// With collapseRepeats, a run is instead written once with a repeat count ("FRAME XREPEAT=n" for
+// Y4M, a "# repeat n" comment for PBM), so a static screen costs a few bytes per second. Players
+// don't understand the count; chip8_expand turns such a stream back into a standard one. All
+// encoding goes into buffers allocated once in Open() and is written out in large blocks, so
+// recording never allocates per frame.
+class FrameSink {
+public:
+    enum class Format { Y4M, PBM };
+
+    FrameSink() = default;
+    ~FrameSink();
+    FrameSink(const FrameSink&) = delete;
+    FrameSink& operator=(const FrameSink&) = delete;
+
+    bool Open(std::string_view path, Format format, int fps = 60, bool collapseRepeats = false);
+    void Submit(const Chip8::Display& display);
+    // Returns false if any write failed; recording stops at the first failure (a full disk, a
+    // closed pipe) and later frames are dropped
+    bool Close();
+
+    [[nodiscard]] bool IsOpen() const { return file != nullptr; }
+    [[nodiscard]] bool Failed() const { return failed; }
+    [[nodiscard]] uint64_t FramesSubmitted() const { return framesSubmitted; }
+    [[nodiscard]] uint64_t FramesEncoded() const { return framesEncoded; }
+    [[nodiscard]] uint64_t FramesWritten() const { return framesWritten; }
+
+    // Picks PBM for *.pbm paths and Y4M for everything else
+    static Format FormatFromPath(std::string_view path);
+
+private:
+    static constexpr size_t kBufferSize = 256 * 1024;
+    static constexpr size_t kMaxFrame = 64 + Chip8::kWidth * Chip8::kHeight;
+
+    void EncodePending();
+    void Flush();
+    void Append(const char* data, size_t size);
+
+    std::FILE* file = nullptr;
+    bool ownsFile = false;
+    bool failed = false;
+    bool collapse = false;
+    Format format = Format::Y4M;
+
+    std::vector<uint8_t> buffer;
+    size_t used = 0;
+
+    // The pending frame encoded once, header included, and copied into buffer per repeat
+    std::vector<uint8_t> frame;
+
+    // Last submitted frame and how many times in a row it has been submitted
+    Chip8::Display pending = { 0 };
+    uint32_t repeat = 0;
+
+    uint64_t framesSubmitted = 0;
+    uint64_t framesEncoded = 0;
+    uint64_t framesWritten = 0;
+};
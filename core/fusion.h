@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include "parser.h"
+
+// Superinstructions recognised by the peephole pass. Each starts with an ordinary instruction and
+// absorbs the ones that follow it at consecutive addresses.
+enum class Superinstruction : uint8_t {
+    NONE,
+    SKIP_JMP,       // 3xkk/4xkk, 1nnn          - conditional jump
+    LD_VX_KK_CHAIN, // 6xkk, 6xkk, ...          - register initialisation
+    LD_I_DRW,       // Annn, Dxyn               - point at a sprite and draw it
+    ADD_SKIP,       // 7xkk, 3xkk/4xkk          - loop counter step and test
+    KEY_WAIT,       // Fx0A                     - not a fusion, marks where Run has to stop
+    TRAPS,          // 2nnn, 00EE, Fx33, Fx55, Fx65, unknown and extensions - not a fusion, Run checks for a trap
+                    // and a watchpoint stop after it
+    DRAW,           // Dxyn                     - not a fusion, Run checks for a watchpoint stop after it
+    BREAK,          // A breakpoint at this address or inside its fusion - set per instance by Memory, Run asks the debugger
+};
+
+// Decoded form of the instruction at an even address
+struct DecodedOp {
+    uint16_t opcode = 0;            // Raw opcode the entry was decoded from
+    Instruction instruction = Instruction::UNKNOWN;
+    Superinstruction fused = Superinstruction::NONE;
+    uint8_t length = 1;             // Instructions the fusion covers, including the first
+    bool valid = false;
+};
+
+// Longest run of LD_VX_KK folded into one LD_VX_KK_CHAIN
+constexpr int kMaxFusedChain = 4;
+
+// Decodes the instruction at address and looks at the following ones for a fusible idiom.
+// Works on anything that reads a byte with operator[] (Memory, RomImage, a plain array).
+template <typename Bytes>
+DecodedOp Decode(const Bytes& memory, uint16_t address) {
+    auto fetch = [&](int at) -> uint16_t {
+        return memory[at & 0xFFF] << 8 | memory[(at + 1) & 0xFFF];
+    };
+
+    DecodedOp op;
+    op.opcode = fetch(address);
+    op.instruction = parse(op.opcode);
+    op.valid = true;
+
+    Instruction next = parse(fetch(address + 2));
+    switch (op.instruction) {
+    case Instruction::SE_VX_KK:
+    case Instruction::SNE_VX_KK:
+        if (next == Instruction::JMP) {
+            op.fused = Superinstruction::SKIP_JMP;
+            op.length = 2;
+        }
+        break;
+    case Instruction::LD_VX_KK:
+        while (op.length < kMaxFusedChain && parse(fetch(address + op.length * 2)) == Instruction::LD_VX_KK) {
+            op.length++;
+        }
+        if (op.length > 1) op.fused = Superinstruction::LD_VX_KK_CHAIN;
+        break;
+    case Instruction::LD_I:
+        if (next == Instruction::DRW) {
+            op.fused = Superinstruction::LD_I_DRW;
+            op.length = 2;
+        }
+        break;
+    case Instruction::ADD_VX_KK:
+        if (next == Instruction::SE_VX_KK || next == Instruction::SNE_VX_KK) {
+            op.fused = Superinstruction::ADD_SKIP;
+            op.length = 2;
+        }
+        break;
+    case Instruction::LD_VX_K:
+        op.fused = Superinstruction::KEY_WAIT;
+        break;
+    case Instruction::DRW:
+        op.fused = Superinstruction::DRAW;
+        break;
+    case Instruction::CALL:
+    case Instruction::RET:
+    case Instruction::LD_B_VX:
+    case Instruction::LD_I_VX:
+    case Instruction::LD_VX_I:
+    case Instruction::UNKNOWN:
+        op.fused = Superinstruction::TRAPS;
+        break;
+    default:
+        // Extensions are decoded but not executed, see parse()
+        if (PlatformOf(op.instruction) != Platform::Chip8) op.fused = Superinstruction::TRAPS;
+        break;
+    }
+
+    return op;
+}
@@ -1,33 +1,156 @@
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <cstdint>
+#include <filesystem>
 #include <GLFW/glfw3.h>
 #include <imgui.h>
 #include "graphics.h"
 #include "parser.h"
+#include "bundled.h"
+#include "classifier.h"
+#include "disassembler.h"
+#include "hash.h"
+#include "image.h"
 
 
-GUI::GUI(Chip8* chip8, GLuint texture, GLubyte* pixels, GLFWwindow* window) : chip8(chip8), displayTexture(texture), displayPixels(pixels), window(window) {
+GUI::GUI(std::span<Chip8> machines, GLuint texture, uint32_t* pixels, GLFWwindow* window) : machines(machines), chip8(&machines.front()), displayTexture(texture), displayPixels(pixels), window(window) {
     memoryEditor.Cols = 8;
     memoryEditor.GotoAddr = 0x2A0;
+
+    // The browser starts in the directory of the ROM given on the command line
+    auto directory = std::filesystem::path(chip8->Rom().path).parent_path().string();
+    if (!directory.empty() && directory.size() < sizeof(libraryPath)) {
+        std::copy_n(directory.c_str(), directory.size() + 1, libraryPath);
+    }
+
+    catalog.Load(RomCatalog::DefaultPath());
+    ApplyCatalog();
 }
 
+namespace {
+
+double NowMillis() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
 void GUI::Tick(GLFWwindow* window) {
-    // Count ticks only if the window is active
-    if (ImGui::IsWindowFocused()) {
-        for (int i = 0; i < 16; ++i) {
-            chip8->keypad[i] = (glfwGetKey(window, chip8->keymap[i]) == GLFW_PRESS);
-        }
+    PollKeypad(window);
+    chip8->Tick();
+}
+
+// Moves the display, keyboard and debug panels to another machine
+void GUI::Focus(size_t instance) {
+    if (instance >= machines.size() || &machines[instance] == chip8) return;
+
+    chip8->keypad.fill(0);
+    chip8->debugger = nullptr;
+    chip8 = &machines[instance];
+    chip8->redraw = true;
+    metrics.Rebase(chip8->counters);
+    latency.Clear();
+
+    disassemblyStart = -1;
+    lastPanelRefresh = {};
+    RefreshPanels(std::chrono::steady_clock::now());
+}
+
+bool GUI::LoadRom(const std::string& path) {
+    Chip8 loader;
+    if (!loader.LoadRom(path)) return false;
+
+    Boot(loader.memory.Image());
+    ApplyCatalog();
+    disassemblyStart = -1;
+    lastPanelRefresh = {};
+    RefreshPanels(std::chrono::steady_clock::now());
+    return true;
+}
+
+void GUI::Boot(std::shared_ptr<const RomImage> image) {
+    for (size_t i = 0; i < machines.size(); ++i) {
+        machines[i].ResetChip8();
+        machines[i].LoadRom(image);
+        machines[i].rand.seed(0, i);
+    }
+    if (debugger.Stopped()) {
+        debugger.Resume(chip8->pc);
     }
+    latency.Clear();
+}
 
-    ticks++;
-    chip8->Tick();
+// The core only reads chip8->keypad, so sample the host keyboard into it before running
+void GUI::PollKeypad(GLFWwindow* window) {
+    for (int i = 0; i < 16; ++i) {
+        chip8->keypad[i] = (glfwGetKey(window, keymap[i]) == GLFW_PRESS);
+    }
+    latency.Input(chip8->keypad, NowMillis());
+}
+
+void GUI::ApplyCatalog() {
+    romHash = HashRom(chip8->Rom());
+    const RomCatalog::Settings* settings = catalog.Find(romHash);
+    runAhead.SetFrames(std::min(settings ? settings->runAhead : 0, kMaxRunAhead));
+    quirksProfile = settings && settings->quirks ? *settings->quirks : Profile::Default;
+
+    // The classifier runs the ROM under every profile, which is too slow for the UI thread
+    bool unknown = !settings || !settings->quirks;
+    bool pending = std::any_of(classifications.begin(), classifications.end(), [&](const auto& entry) { return entry.hash == romHash; });
+    if (unknown && !pending) {
+        auto classify = [image = chip8->memory.Image()] { return Classify(image).profile; };
+        classifications.push_back({ romHash, chip8->Rom().title, std::async(std::launch::async, classify) });
+    }
+
+    for (auto& machine : machines) {
+        machine.quirks = QuirksFor(quirksProfile);
+        // Only ever called right after a load, so a bundled ROM can start from its baked boot
+        ApplyBakedBoot(machine);
+    }
+    chip8->redraw = true;
+}
+
+void GUI::PollClassifications() {
+    std::erase_if(classifications, [&](PendingClassification& pending) {
+        if (pending.profile.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+
+        // A profile saved from the General panel in the meantime wins
+        RomCatalog::Settings& entry = catalog[pending.hash];
+        if (!entry.quirks) {
+            entry.quirks = pending.profile.get();
+            if (entry.title.empty()) entry.title = pending.title;
+            catalog.Save();
+        }
+
+        // Unless the user already picked another profile, restart the loaded ROM under the right one
+        if (pending.hash == romHash && quirksProfile == Profile::Default && *entry.quirks != Profile::Default) {
+            quirksProfile = *entry.quirks;
+            Boot(chip8->memory.Image());
+            for (auto& machine : machines) {
+                machine.quirks = QuirksFor(quirksProfile);
+            }
+            chip8->redraw = true;
+            disassemblyStart = -1;
+            lastPanelRefresh = {};
+        }
+        return true;
+    });
+}
+
+void GUI::Presented() {
+    latency.Present(NowMillis());
 }
 
 
 void GUI::Render() {
     auto framerate = ImGui::GetIO().Framerate;
+    auto frameStart = std::chrono::steady_clock::now();
+
+    if (!classifications.empty()) PollClassifications();
 
     RenderDisplay(framerate);
+    RefreshPanels(frameStart);
     RenderGeneral(framerate);
     RenderRom();
     RenderDisassembler();
@@ -36,6 +159,58 @@ void GUI::Render() {
     RenderMemory();
     RenderKeypadState();
     RenderStack();
+    RenderPerformance();
+    RenderWall();
+    RenderBrowser();
+
+    // Everything after emulation and texture upload counts as UI time
+    using ms = std::chrono::duration<float, std::milli>;
+    auto frameEnd = std::chrono::steady_clock::now();
+    emulationTimes[frameHistoryOffset] = emulationTime;
+    uploadTimes[frameHistoryOffset] = uploadTime;
+    runAheadTimes[frameHistoryOffset] = runAheadTime;
+    uiTimes[frameHistoryOffset] = ms(frameEnd - frameStart).count() - emulationTime - uploadTime - runAheadTime;
+    frameTimes[frameHistoryOffset] = ms(frameStart - lastFrame).count();
+    frameHistoryOffset = (frameHistoryOffset + 1) % kFrameHistory;
+    lastFrame = frameStart;
+
+    metrics.Collect(chip8->counters);
+    metrics.Add(metrics.wallFrames);
+    metricsRegistry.UpdateRates();
+}
+
+Renderer::Options GUI::RenderOptions(int scale) const {
+    auto channel = [](float value) { return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f); };
+
+    Renderer::Options options;
+    options.scale = scale;
+    options.foreground = Renderer::Rgba(channel(foregroundColour.x), channel(foregroundColour.y), channel(foregroundColour.z));
+    options.background = Renderer::Rgba(channel(backgroundColour.x), channel(backgroundColour.y), channel(backgroundColour.z));
+    return options;
+}
+
+void GUI::SaveScreenshot() {
+    auto options = RenderOptions(kDisplayScale);
+    options.filter = static_cast<Renderer::Filter>(screenshotFilter);
+
+    std::vector<uint32_t> pixels;
+    Renderer::Render(chip8->display, options, pixels);
+    WriteImage(screenshotPath, pixels.data(), Chip8::kWidth * options.scale, Chip8::kHeight * options.scale);
+}
+
+bool GUI::IsIdle() const {
+    return clockSpeed == 0 && !tickRequested;
+}
+
+void GUI::RefreshPanels(steady_time_point now) {
+    // While paused frames only happen on input, so every one of them refreshes
+    if (clockSpeed != 0 && panelRefreshRate > 0 && now - lastPanelRefresh < std::chrono::duration<double>(1.0 / panelRefreshRate)) {
+        return;
+    }
+
+    chip8->SaveState(panel);
+    panelGeneration = chip8->memory.Generation();
+    lastPanelRefresh = now;
 }
 
 // Renders the game (reminder: no title bar)
@@ -43,64 +218,109 @@ void GUI::RenderDisplay(float framerate) {
     ImGui::SetNextWindowSizeConstraints(ImVec2(200, 200), ImVec2(FLT_MAX, FLT_MAX)); // Set minimum size and allow maximum expansion
     ImGui::Begin("Display", NULL, ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_AlwaysAutoResize);
 
+    chip8->debugger = debugger.Armed() ? &debugger : nullptr;
+
     if (tickRequested) {
         tickRequested = false;
+        debugger.Resume(chip8->pc);
         Tick(window);
     }
 
-    for (int i = 0; i < (clockSpeed / framerate); ++i) {
-        Tick(window);
+    // This frame's share of the clock goes through the fused engine, which returns early on a debugger stop
+    using ms = std::chrono::duration<float, std::milli>;
+    auto emulationStart = std::chrono::steady_clock::now();
+    int cycles = framerate > 0 ? static_cast<int>(std::ceil(clockSpeed / framerate)) : 0;
+    if (cycles > 0) {
+        PollKeypad(window);
+        chip8->Run(cycles);
+
+        // The others run unattended, without keys or a debugger
+        for (auto& machine : machines) {
+            if (&machine != chip8) machine.Run(cycles);
+        }
+    }
+    emulationTime = ms(std::chrono::steady_clock::now() - emulationStart).count();
+
+    if (debugger.Stopped() && clockSpeed != 0) {
+        Pause();
+        auto reason = debugger.Reason();
+        if (reason == Debugger::Stop::Read || reason == Debugger::Stop::Write) {
+            memoryEditor.GotoAddrAndHighlight(debugger.StopAddress(), debugger.StopAddress() + 1);
+        }
     }
 
-    auto currentTime = std::chrono::high_resolution_clock::now();
-    if ((currentTime - lastTimer).count() >= 16666666) {
-        chip8->TickTimer();
+    // The timer runs at most once per GUI frame, so with slow frames whole 60 Hz periods are lost
+    constexpr auto kTimerPeriod = std::chrono::nanoseconds(16666666);
+    auto currentTime = std::chrono::steady_clock::now();
+    if (auto elapsed = currentTime - lastTimer; elapsed >= kTimerPeriod) {
+        for (auto& machine : machines) {
+            machine.TickTimer();
+        }
         lastTimer = currentTime;
+
+        if (clockSpeed != 0) {
+            metrics.Add(metrics.skippedFrames, elapsed / kTimerPeriod - 1);
+            metrics.schedulerLagMicros.store(std::chrono::duration_cast<std::chrono::microseconds>(elapsed - kTimerPeriod).count(), std::memory_order_relaxed);
+        }
     }
 
     if (chip8->beep) {
         chip8->beep = false;
     }
 
-    if (chip8->redraw) {
+    // Run-ahead shows a copy some frames in the future, never while paused or debugging
+    bool ahead = cycles > 0 && !debugger.Armed() && runAhead.Frames() > 0;
+    const Chip8& shown = ahead ? runAhead.Run(*chip8, std::max(1, clockSpeed / 60)) : *chip8;
+    if (ahead != presentedAhead) {
+        presentedAhead = ahead;
+        chip8->redraw = true;
+    }
+    runAheadTime = ahead ? static_cast<float>(runAhead.Millis()) : 0.0f;
+
+    auto uploadStart = std::chrono::steady_clock::now();
+    if (chip8->redraw || shown.redraw) {
         chip8->redraw = false;
 
-        // Use user-specified custom coloring
-        GLubyte fg[3] = { foregroundColour.x * 255,
-                          foregroundColour.y * 255,
-                          foregroundColour.z * 255 };
-        GLubyte bg[3] = { backgroundColour.x * 255,
-                          backgroundColour.y * 255,
-                          backgroundColour.z * 255 };
-
-        // Update the displayPixels based on chip8->display
-        for (int i = 0; i < Chip8::kWidth * Chip8::kHeight; ++i) {
-            auto subpixel = chip8->display[i] ? fg : bg;
-            for (int j = 0; j < 3; j++) {
-                displayPixels[i * 3 + j] = subpixel[j];
-            }
-        }
+        // Update the displayPixels based on the presented display, GL scales the texture
+        Renderer::Render(shown.display, RenderOptions(1), displayPixels, Chip8::kWidth);
 
         // Update the OpenGL texture
         glBindTexture(GL_TEXTURE_2D, displayTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, Chip8::kWidth, Chip8::kHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, displayPixels);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, Chip8::kWidth, Chip8::kHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, displayPixels);
         glBindTexture(GL_TEXTURE_2D, 0);
+        metrics.Add(metrics.textureUploads);
     }
+    uploadTime = ms(std::chrono::steady_clock::now() - uploadStart).count();
+    latency.Display(shown.display, NowMillis());
 
     ImGui::Image((void*)(intptr_t)displayTexture, ImVec2(Chip8::kWidth * kDisplayScale, Chip8::kHeight * kDisplayScale));
     ImGui::End();
 }
 
 void GUI::RenderGeneral(float framerate) {
-    ImGui::Begin("General", NULL, ImGuiWindowFlags_AlwaysAutoResize);
+    if (!ImGui::Begin("General", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::End();
+        return;
+    }
 
     ImGui::TextColored(labelColor, "FPS:");
     ImGui::SameLine();
     ImGui::Text("%f", framerate);
 
-    ImGui::TextColored(labelColor, "Ticks:");
+    constexpr auto kRelaxed = std::memory_order_relaxed;
+    ImGui::TextColored(labelColor, "Instructions:");
+    ImGui::SameLine();
+    ImGui::Text("%llu (%.2f MIPS)", static_cast<unsigned long long>(metrics.instructions.load(kRelaxed)), metrics.mips.load(kRelaxed));
+
+    ImGui::TextColored(labelColor, "Emulated Frames:");
+    ImGui::SameLine();
+    ImGui::Text("%.1f/s, %llu skipped, %lld us lag", metrics.emulatedFps.load(kRelaxed),
+                static_cast<unsigned long long>(metrics.skippedFrames.load(kRelaxed)), static_cast<long long>(metrics.schedulerLagMicros.load(kRelaxed)));
+
+    ImGui::TextColored(labelColor, "Draws:");
     ImGui::SameLine();
-    ImGui::Text("%d", ticks);
+    ImGui::Text("%llu, %llu texture uploads", static_cast<unsigned long long>(metrics.draws.load(kRelaxed)),
+                static_cast<unsigned long long>(metrics.textureUploads.load(kRelaxed)));
 
     ImGui::TextColored(labelColor, "Display Scale:");
     ImGui::SameLine();
@@ -112,6 +332,39 @@ void GUI::RenderGeneral(float framerate) {
     ImGui::InputInt("Hz", &clockSpeed);
     ImGui::PopItemWidth();
 
+    ImGui::TextColored(labelColor, "Run-ahead:");
+    ImGui::SameLine();
+    ImGui::PushItemWidth(100);
+    int frames = runAhead.Frames();
+    if (ImGui::SliderInt("frames", &frames, 0, kMaxRunAhead)) {
+        runAhead.SetFrames(frames);
+    }
+    ImGui::PopItemWidth();
+
+    ImGui::TextColored(labelColor, "Quirks:");
+    ImGui::SameLine();
+    ImGui::PushItemWidth(100);
+    int profile = static_cast<int>(quirksProfile);
+    if (ImGui::Combo("##quirks", &profile, "default\0chip8\0schip\0xochip\0")) {
+        quirksProfile = static_cast<Profile>(profile);
+        for (auto& machine : machines) {
+            machine.quirks = QuirksFor(quirksProfile);
+        }
+    }
+    ImGui::PopItemWidth();
+    ImGui::SameLine();
+    if (ImGui::Button("Save for ROM")) {
+        RomCatalog::Settings& settings = catalog[romHash];
+        settings.runAhead = runAhead.Frames();
+        settings.quirks = quirksProfile;
+        settings.title = chip8->Rom().title;
+        catalog.Save();
+    }
+    if (runAhead.Frames() > 0) {
+        ImGui::Text("%.3f ms, %llu extra instructions per frame", runAheadTime,
+                    static_cast<unsigned long long>(presentedAhead ? runAhead.Instructions() : 0));
+    }
+
     ImGui::PushItemWidth(150);
     ImGui::ColorEdit3("FG Color", (float*)&foregroundColour);
     ImGui::ColorEdit3("BG Color", (float*)&backgroundColour);
@@ -120,6 +373,15 @@ void GUI::RenderGeneral(float framerate) {
     ImGui::SliderInt("Display Scale", &kDisplayScale, 1, 20);
     ImGui::PopItemWidth();
 
+    ImGui::Separator();
+    ImGui::PushItemWidth(150);
+    ImGui::InputText("##screenshotPath", screenshotPath, sizeof(screenshotPath));
+    ImGui::Combo("Filter", &screenshotFilter, "None\0Scanlines\0Grid\0");
+    ImGui::PopItemWidth();
+    if (ImGui::Button("Screenshot")) {
+        SaveScreenshot();
+    }
+
 
     ImGui::End();
 }
@@ -129,10 +391,13 @@ void GUI::RenderRom() {
     float romFactorW = 0.25;
 
     ImGui::SetNextWindowSize(ImVec2(Chip8::kWindowWidth * romFactorW, Chip8::kWindowHeight * romFactorH));
-    ImGui::Begin("ROM", NULL, ImGuiWindowFlags_AlwaysAutoResize);
-    ImGui::TextWrapped("ROM Title: %s", chip8->romTitle.c_str());
-    ImGui::TextWrapped("ROM Path: %s", chip8->romPath.c_str());
-    ImGui::TextWrapped("Rom Size (Bytes): %d", chip8->romSize);
+    if (!ImGui::Begin("ROM", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::End();
+        return;
+    }
+    ImGui::TextWrapped("ROM Title: %s", chip8->Rom().title.c_str());
+    ImGui::TextWrapped("ROM Path: %s", chip8->Rom().path.c_str());
+    ImGui::TextWrapped("Rom Size (Bytes): %zu", chip8->Rom().size);
     ImGui::End();
 }
 
@@ -141,40 +406,60 @@ void GUI::RenderDisassembler() {
     float disassemblerW = 0.2f;
     bool followProgramCounter = true;
 
-    ImGui::Begin("Disassembler", NULL, ImGuiWindowFlags_AlwaysAutoResize);
+    if (!ImGui::Begin("Disassembler", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::End();
+        return;
+    }
     ImGui::Checkbox("Follow PC", &followProgramCounter);
     ImGui::Separator();
 
     // Display the current instruction at the program counter
-    uint16_t current_instruction = (chip8->memory[chip8->pc] << 8) | chip8->memory[chip8->pc + 1];
-    ImGui::Text("PC: %04X | Current Instruction: %04X", chip8->pc, current_instruction);
+    uint16_t current_instruction = (panel.memory[panel.pc & 0xFFF] << 8) | panel.memory[(panel.pc + 1) & 0xFFF];
+    ImGui::Text("PC: %04X | Current Instruction: %04X", panel.pc, current_instruction);
     ImGui::Separator();
 
     // Start displaying memory content
     ImGui::BeginChild("Instructions", ImVec2(0, -ImGui::GetFrameHeightWithSpacing()), false, ImGuiWindowFlags_HorizontalScrollbar);
 
-    int endAddress = std::min(int(chip8->memory.size()), chip8->pc + 20 * 2); 
-    for (int address = std::max(0, chip8->pc - 20 * 2); address < endAddress; address += 2) {
-        uint16_t opcode = (chip8->memory[address] << 8) | chip8->memory[address + 1];
-        auto disassembly = DisassembleOpcode(opcode, address);
+    int startAddress = std::max(0, panel.pc - 20 * 2);
+    int endAddress = std::min(int(panel.memory.size()) - 1, panel.pc + 20 * 2); 
+
+    // Re-disassemble only when the pc moved or any byte in the pages in view changed since the last rebuild
+    uint16_t viewPages = uint16_t(1u << (startAddress >> 8) | 1u << (endAddress >> 8));
+    if (startAddress != disassemblyStart || panel.pc != disassemblyPc ||
+        (panelGeneration != disassemblyGeneration && (chip8->memory.ChangedSince(disassemblyGeneration) & viewPages))) {
+        disassemblyLines.clear();
+        for (int address = startAddress; address < endAddress; address += 2) {
+            uint16_t opcode = (panel.memory[address] << 8) | panel.memory[address + 1];
+            disassemblyLines.push_back(DisassembleOpcode(opcode, address));
+        }
+        disassemblyGeneration = panelGeneration;
+        disassemblyStart = startAddress;
+        disassemblyPc = panel.pc;
+    }
+
+    for (int address = startAddress, line = 0; address < endAddress; address += 2, ++line) {
+        uint16_t opcode = (panel.memory[address] << 8) | panel.memory[address + 1];
         char lineBuffer[256];
 
-        // Format the display line
-        snprintf(lineBuffer, sizeof(lineBuffer), "0x%04X | %04X | %s", address, opcode, disassembly.c_str());
+        // Format the display line, breakpoints are marked with '*'
+        bool breakpoint = debugger.Breakpoints().test(address);
+        snprintf(lineBuffer, sizeof(lineBuffer), "%c 0x%04X | %04X | %s", breakpoint ? '*' : ' ', address, opcode, disassemblyLines[line].c_str());
 
-        // Highlight the current PC
-        if (address == chip8->pc) {
-            ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.0f, 0.8f, 0.0f, 1.0f)); 
+        // Highlight the current PC, click any line to toggle a breakpoint on it
+        ImGui::PushStyleColor(ImGuiCol_Text, breakpoint ? labelColor : ImVec4(0.0f, 0.8f, 0.0f, 1.0f));
+        if (address == panel.pc) {
             ImGui::PushStyleColor(ImGuiCol_TextSelectedBg, ImVec4(0.5f, 0.7f, 1.0f, 0.5f)); 
-            ImGui::Selectable(lineBuffer, true, ImGuiSelectableFlags_AllowDoubleClick);
-            ImGui::PopStyleColor(2);
+            if (ImGui::Selectable(lineBuffer, true)) {
+                debugger.ToggleBreakpoint(address);
+            }
+            ImGui::PopStyleColor();
             if (followProgramCounter)
                 ImGui::SetScrollHereY();
-        } else {
-            ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.0f, 0.8f, 0.0f, 1.0f)); 
-            ImGui::Text("%s", lineBuffer);
-            ImGui::PopStyleColor(); 
+        } else if (ImGui::Selectable(lineBuffer, false)) {
+            debugger.ToggleBreakpoint(address);
         }
+        ImGui::PopStyleColor(); 
     }
 
     ImGui::EndChild();
@@ -183,135 +468,38 @@ void GUI::RenderDisassembler() {
 
 
 std::string GUI::DisassembleOpcode(uint16_t opcode, int address) {
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0');
-    Instruction instr = parse(Opcode(opcode));
-
-    switch (instr) {
-    case Instruction::CLS:
-        ss << "CLS";
-        break;
-    case Instruction::RET:
-        ss << "RET";
-        break;
-    case Instruction::JMP:
-        ss << "JP " << std::setw(4) << (opcode & 0x0FFF);
-        break;
-    case Instruction::CALL:
-        ss << "CALL " << std::setw(4) << (opcode & 0x0FFF);
-        break;
-    case Instruction::SE_VX_KK:
-        ss << "SE V" << ((opcode & 0x0F00) >> 8) << ", " << std::setw(2) << std::setfill('0') << (opcode & 0x00FF);
-        break;
-    case Instruction::SNE_VX_KK:
-        ss << "SNE V" << ((opcode & 0x0F00) >> 8) << ", " << std::setw(2) << std::setfill('0') << (opcode & 0x00FF);
-        break;
-    case Instruction::SE_VX_VY:
-        ss << "SE V" << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4);
-        break;
-    case Instruction::LD_VX_KK:
-        ss << "LD V" << ((opcode & 0x0F00) >> 8) << ", " << std::setw(2) << std::setfill('0') << (opcode & 0x00FF);
-        break;
-    case Instruction::ADD_VX_KK:
-        ss << "ADD V" << ((opcode & 0x0F00) >> 8) << ", " << std::setw(2) << std::setfill('0') << (opcode & 0x00FF);
-        break;
-    case Instruction::LD_VX_VY:
-        ss << "LD V" << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4);
-        break;
-    case Instruction::OR_VX_VY:
-        ss << "OR V" << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4);
-        break;
-    case Instruction::AND_VX_VY:
-        ss << "AND V" << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4);
-        break;
-    case Instruction::XOR_VX_VY:
-        ss << "XOR V" << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4);
-        break;
-    case Instruction::ADD_VX_VY:
-        ss << "ADD V" << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4);
-        break;
-    case Instruction::SUB_VX_VY:
-        ss << "SUB V" << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4);
-        break;
-    case Instruction::SHR_VX:
-        ss << "SHR V" << ((opcode & 0x0F00) >> 8);
-        break;
-    case Instruction::SUBN_VX_VY:
-        ss << "SUBN V" << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4);
-        break;
-    case Instruction::SHL_VX:
-        ss << "SHL V" << ((opcode & 0x0F00) >> 8);
-        break;
-    case Instruction::SNE_VX_VY:
-        ss << "SNE V" << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4);
-        break;
-    case Instruction::LD_I:
-        ss << "LD I, " << std::setw(4) << (opcode & 0x0FFF);
-        break;
-    case Instruction::JMP_V0:
-        ss << "JP V0, " << std::setw(4) << (opcode & 0x0FFF);
-        break;
-    case Instruction::RND:
-        ss << "RND V" << ((opcode & 0x0F00) >> 8) << ", " << std::setw(2) << std::setfill('0') << (opcode & 0x00FF);
-        break;
-    case Instruction::DRW:
-        ss << "DRW V" << ((opcode & 0x0F00) >> 8) << ", V" << ((opcode & 0x00F0) >> 4) << ", " << (opcode & 0x000F);
-        break;
-    case Instruction::SKP:
-        ss << "SKP V" << ((opcode & 0x0F00) >> 8);
-        break;
-    case Instruction::SKNP:
-        ss << "SKNP V" << ((opcode & 0x0F00) >> 8);
-        break;
-    case Instruction::LD_VX_DT:
-        ss << "LD V" << ((opcode & 0x0F00) >> 8) << ", DT";
-        break;
-    case Instruction::LD_VX_K:
-        ss << "LD V" << ((opcode & 0x0F00) >> 8) << ", K";
-        break;
-    case Instruction::LD_DT:
-        ss << "LD DT, V" << ((opcode & 0x0F00) >> 8);
-        break;
-    case Instruction::LD_ST:
-        ss << "LD ST, V" << ((opcode & 0x0F00) >> 8);
-        break;
-    case Instruction::ADD_I_VX:
-        ss << "ADD I, V" << ((opcode & 0x0F00) >> 8);
-        break;
-    case Instruction::LD_F_VX:
-        ss << "LD F, V" << ((opcode & 0x0F00) >> 8);
-        break;
-    case Instruction::LD_B_VX:
-        ss << "LD B, V" << ((opcode & 0x0F00) >> 8);
-        break;
-    case Instruction::LD_I_VX:
-        ss << "LD [I], V" << ((opcode & 0x0F00) >> 8);
-        break;
-    case Instruction::LD_VX_I:
-        ss << "LD V" << ((opcode & 0x0F00) >> 8) << ", [I]";
-        break;
-    default:
-        ss << "Unknown Opcode: " << std::setw(4) << opcode;
-        break;
-    }
-
-    return ss.str();
+    return Disassemble(opcode);
 }
 
 void GUI::RenderCPUState() {
-    ImGui::Begin("CPU State", NULL, ImGuiWindowFlags_AlwaysAutoResize);
+    if (!ImGui::Begin("CPU State", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::End();
+        return;
+    }
 
     ImGui::TextColored(labelColor, "PC:");
     ImGui::SameLine();
-    ImGui::Text("%04X", chip8->pc);
+    ImGui::Text("%04X", panel.pc);
 
     ImGui::TextColored(labelColor, "IR:");
     ImGui::SameLine();
-    ImGui::Text("%04X", chip8->index);
+    ImGui::Text("%04X", panel.index);
 
     ImGui::TextColored(labelColor, "OP:");
     ImGui::SameLine();
-    ImGui::Text("%04X", chip8->opcode);
+    ImGui::Text("%04X", panel.opcode);
+
+    ImGui::TextColored(labelColor, "State:");
+    ImGui::SameLine();
+    if (panel.cpuState == Chip8::CpuState::Running) {
+        ImGui::Text("running");
+    } else if (panel.cpuState == Chip8::CpuState::Trapped) {
+        ImGui::TextColored(labelColor, "trapped: %s, reset or load a ROM", Chip8::TrapName(panel.trap));
+    } else if (panel.waitKey < 0) {
+        ImGui::Text("waiting for a key press (V%01X)", panel.waitRegister);
+    } else {
+        ImGui::Text("waiting for key %01X to be released (V%01X)", panel.waitKey, panel.waitRegister);
+    }
 
     ImGui::NewLine();
     ImGui::TextColored(labelColor, "Reg (V)");
@@ -319,7 +507,7 @@ void GUI::RenderCPUState() {
     for (int i = 0; i < 16; ++i) {
         ImGui::TextColored(labelColor, "%01X:", i);
         ImGui::SameLine();
-        ImGui::Text("%02X  ", chip8->registers[i]);
+        ImGui::Text("%02X  ", panel.registers[i]);
         if (i % 2 == 0) {
             ImGui::SameLine();
         }
@@ -329,31 +517,37 @@ void GUI::RenderCPUState() {
 
     ImGui::TextColored(labelColor, "DT:");
     ImGui::SameLine();
-    ImGui::Text("%02X", chip8->delayTimer);
+    ImGui::Text("%02X", panel.delayTimer);
 
     ImGui::TextColored(labelColor, "ST:");
     ImGui::SameLine();
-    ImGui::Text("%02X", chip8->soundTimer);
+    ImGui::Text("%02X", panel.soundTimer);
 
     ImGui::End();
 }
 
 void GUI::RenderDebug() {
-    ImGui::Begin("Debug", NULL, ImGuiWindowFlags_AlwaysAutoResize);
+    if (!ImGui::Begin("Debug", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::End();
+        return;
+    }
 
     ImGui::TextColored(labelColor, "Status: ");
     ImGui::SameLine();
-    ImGui::Text(clockSpeed == 0 ? "paused" : "running");
+    if (debugger.Stopped()) {
+        ImGui::Text("stopped at %04X (%s)", debugger.StopAddress(), Debugger::Describe(debugger.Reason()));
+    } else {
+        ImGui::Text(clockSpeed == 0 ? "paused" : "running");
+    }
 
     ImGui::TextColored(labelColor, "Clock: ");
     ImGui::SameLine();
     if (ImGui::Button(clockSpeed == 0 ? "resume" : "pause")) {
         if (clockSpeed == 0) {
-            clockSpeed = prevClockSpeed;
+            Resume();
         }
         else {
-            prevClockSpeed = clockSpeed;
-            clockSpeed = 0;
+            Pause();
         }
     }
 
@@ -361,77 +555,389 @@ void GUI::RenderDebug() {
         tickRequested = true;
     }
 
+    ImGui::Separator();
+    ImGui::TextColored(labelColor, "Breakpoints: ");
+    ImGui::SameLine();
+    ImGui::Text("%zu", debugger.Breakpoints().count());
+    ImGui::SameLine();
+    if (ImGui::Button("clear")) {
+        debugger.ClearBreakpoints();
+    }
+
+    // Stop when a register or I becomes equal to a value
+    static const char* registerNames[] = { "V0", "V1", "V2", "V3", "V4", "V5", "V6", "V7",
+                                           "V8", "V9", "VA", "VB", "VC", "VD", "VE", "VF", "I" };
+    ImGui::TextColored(labelColor, "Break when:");
+    ImGui::PushItemWidth(60);
+    ImGui::Combo("##conditionRegister", &conditionRegister, registerNames, IM_ARRAYSIZE(registerNames));
+    ImGui::SameLine();
+    ImGui::InputInt("##conditionValue", &conditionValue, 0, 0, ImGuiInputTextFlags_CharsHexadecimal);
+    ImGui::PopItemWidth();
+    ImGui::SameLine();
+    if (ImGui::Button("add")) {
+        debugger.conditions.push_back({ conditionRegister, static_cast<uint16_t>(conditionValue) });
+    }
+
+    for (size_t i = 0; i < debugger.conditions.size(); ++i) {
+        const auto& condition = debugger.conditions[i];
+        ImGui::PushID(static_cast<int>(i));
+        ImGui::Text("%s == %X", registerNames[condition.reg], condition.value);
+        ImGui::SameLine();
+        if (ImGui::Button("remove")) {
+            debugger.conditions.erase(debugger.conditions.begin() + i);
+        }
+        ImGui::PopID();
+    }
+
     ImGui::End();
 }
 
+void GUI::Pause() {
+    if (clockSpeed != 0) {
+        prevClockSpeed = clockSpeed;
+        clockSpeed = 0;
+    }
+}
+
+void GUI::Resume() {
+    if (clockSpeed == 0) {
+        clockSpeed = prevClockSpeed;
+    }
+    debugger.Resume(chip8->pc);
+}
+
 void GUI::RenderMemory() {
-    ImGui::Begin("Memory Editor", NULL, ImGuiWindowFlags_AlwaysAutoResize);
-    memoryEditor.DrawContents(std::data(chip8->memory), 4096);
+    if (!ImGui::Begin("Memory Editor", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::End();
+        return;
+    }
+
+    // Watchpoints stop execution after an instruction reads or writes the watched byte
+    ImGui::TextColored(labelColor, "Watch:");
+    ImGui::SameLine();
+    ImGui::PushItemWidth(60);
+    ImGui::InputInt("##watchAddress", &watchAddress, 0, 0, ImGuiInputTextFlags_CharsHexadecimal);
+    ImGui::PopItemWidth();
+    watchAddress &= 0xFFF;
+    ImGui::SameLine();
+    ImGui::Checkbox("read", &watchRead);
+    ImGui::SameLine();
+    ImGui::Checkbox("write", &watchWrite);
+    ImGui::SameLine();
+    if (ImGui::Button("set")) {
+        debugger.readWatch.set(watchAddress, watchRead);
+        debugger.writeWatch.set(watchAddress, watchWrite);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("clear all")) {
+        debugger.readWatch.reset();
+        debugger.writeWatch.reset();
+    }
+
+    for (int address = 0; address < 4096; ++address) {
+        bool read = debugger.readWatch.test(address);
+        bool write = debugger.writeWatch.test(address);
+        if (!read && !write) continue;
+
+        ImGui::PushID(address);
+        ImGui::Text("%03X %s%s", address, read ? "R" : "", write ? "W" : "");
+        ImGui::SameLine();
+        if (ImGui::Button("goto")) {
+            memoryEditor.GotoAddrAndHighlight(address, address + 1);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("remove")) {
+            debugger.readWatch.reset(address);
+            debugger.writeWatch.reset(address);
+        }
+        ImGui::PopID();
+    }
+    ImGui::Separator();
+
+    // Edits are made on the snapshot and the bytes that changed are written through to the emulator
+    auto before = panel.memory;
+    memoryEditor.DrawContents(std::data(panel.memory), panel.memory.size());
+    for (size_t address = 0; address < panel.memory.size(); ++address) {
+        if (panel.memory[address] != before[address]) {
+            chip8->memory.Write(address, panel.memory[address]);
+        }
+    }
     ImGui::End();
 }
 
 void GUI::RenderKeypadState() {
-    ImGui::Begin("Keypad", NULL, ImGuiWindowFlags_AlwaysAutoResize);
+    if (!ImGui::Begin("Keypad", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::End();
+        return;
+    }
 
-    ImGui::TextColored(chip8->keypad[0x1] ? successColor : labelColor, "1");
+    ImGui::TextColored(panel.keypad[0x1] ? successColor : labelColor, "1");
     ImGui::SameLine();
-    ImGui::TextColored(chip8->keypad[0x2] ? successColor : labelColor, "2");
+    ImGui::TextColored(panel.keypad[0x2] ? successColor : labelColor, "2");
     ImGui::SameLine();
-    ImGui::TextColored(chip8->keypad[0x3] ? successColor : labelColor, "3");
+    ImGui::TextColored(panel.keypad[0x3] ? successColor : labelColor, "3");
     ImGui::SameLine();
-    ImGui::TextColored(chip8->keypad[0xC] ? successColor : labelColor, "C");
+    ImGui::TextColored(panel.keypad[0xC] ? successColor : labelColor, "C");
     ImGui::Separator();
 
-    ImGui::TextColored(chip8->keypad[0x4] ? successColor : labelColor, "4");
+    ImGui::TextColored(panel.keypad[0x4] ? successColor : labelColor, "4");
     ImGui::SameLine();
-    ImGui::TextColored(chip8->keypad[0x5] ? successColor : labelColor, "5");
+    ImGui::TextColored(panel.keypad[0x5] ? successColor : labelColor, "5");
     ImGui::SameLine();
-    ImGui::TextColored(chip8->keypad[0x6] ? successColor : labelColor, "6");
+    ImGui::TextColored(panel.keypad[0x6] ? successColor : labelColor, "6");
     ImGui::SameLine();
-    ImGui::TextColored(chip8->keypad[0xD] ? successColor : labelColor, "D");
+    ImGui::TextColored(panel.keypad[0xD] ? successColor : labelColor, "D");
     ImGui::Separator();
 
-    ImGui::TextColored(chip8->keypad[0x7] ? successColor : labelColor, "7");
+    ImGui::TextColored(panel.keypad[0x7] ? successColor : labelColor, "7");
     ImGui::SameLine();
-    ImGui::TextColored(chip8->keypad[0x8] ? successColor : labelColor, "8");
+    ImGui::TextColored(panel.keypad[0x8] ? successColor : labelColor, "8");
     ImGui::SameLine();
-    ImGui::TextColored(chip8->keypad[0x9] ? successColor : labelColor, "9");
+    ImGui::TextColored(panel.keypad[0x9] ? successColor : labelColor, "9");
     ImGui::SameLine();
-    ImGui::TextColored(chip8->keypad[0xE] ? successColor : labelColor, "E");
+    ImGui::TextColored(panel.keypad[0xE] ? successColor : labelColor, "E");
     ImGui::Separator();
 
-    ImGui::TextColored(chip8->keypad[0xA] ? successColor : labelColor, "A");
+    ImGui::TextColored(panel.keypad[0xA] ? successColor : labelColor, "A");
     ImGui::SameLine();
-    ImGui::TextColored(chip8->keypad[0x0] ? successColor : labelColor, "0");
+    ImGui::TextColored(panel.keypad[0x0] ? successColor : labelColor, "0");
     ImGui::SameLine();
-    ImGui::TextColored(chip8->keypad[0xB] ? successColor : labelColor, "B");
+    ImGui::TextColored(panel.keypad[0xB] ? successColor : labelColor, "B");
     ImGui::SameLine();
-    ImGui::TextColored(chip8->keypad[0xF] ? successColor : labelColor, "F");
+    ImGui::TextColored(panel.keypad[0xF] ? successColor : labelColor, "F");
     ImGui::Separator();
 
     ImGui::End();
 }
 
 void GUI::RenderStack() {
-    ImGui::Begin("Stack", NULL, ImGuiWindowFlags_AlwaysAutoResize);
+    if (!ImGui::Begin("Stack", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::End();
+        return;
+    }
     ImGui::Columns(2, NULL, true);
 
     // First column: Display the first 8 entries
     for (int i = 0; i < 8; ++i) {
-        ImGui::TextColored(chip8->sp == i ? successColor : labelColor, "%X:", i);
+        ImGui::TextColored(panel.sp == i ? successColor : labelColor, "%X:", i);
         ImGui::SameLine();
-        ImGui::Text("%04X", chip8->stack[i]);
+        ImGui::Text("%04X", panel.stack[i]);
     }
 
     ImGui::NextColumn();
 
     // Second column: Display the next 8 entries
     for (int i = 8; i < 16; ++i) {
-        ImGui::TextColored(chip8->sp == i ? successColor : labelColor, "%X:", i);
+        ImGui::TextColored(panel.sp == i ? successColor : labelColor, "%X:", i);
         ImGui::SameLine();
-        ImGui::Text("%04X", chip8->stack[i]);
+        ImGui::Text("%04X", panel.stack[i]);
     }
 
     ImGui::Columns(1);
     ImGui::End();
 }
+
+void GUI::RenderWall() {
+    if (machines.size() < 2) return;
+
+    auto options = RenderOptions(1);
+    if (!atlas) {
+        int columns = static_cast<int>(std::ceil(std::sqrt(double(machines.size()))));
+        atlas = std::make_unique<Renderer::Atlas>(options, static_cast<int>(machines.size()), columns);
+        atlasOptions = options;
+    } else if (options.foreground != atlasOptions.foreground || options.background != atlasOptions.background) {
+        atlas->Invalidate(options);
+        atlasOptions = options;
+    }
+
+    // Only tiles whose display changed are re-rendered, and one upload covers the rows they span
+    for (size_t i = 0; i < machines.size(); ++i) {
+        atlas->Update(static_cast<int>(i), machines[i].display);
+    }
+    if (UploadAtlas(*atlas, atlasTexture)) {
+        metrics.Add(metrics.textureUploads);
+    }
+
+    if (!ImGui::Begin("Wall", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::End();
+        return;
+    }
+
+    ImGui::PushItemWidth(100);
+    ImGui::SliderInt("Tile Scale", &wallScale, 1, 4);
+    ImGui::PopItemWidth();
+
+    auto tileSize = ImVec2(float(Renderer::Atlas::kTileWidth * wallScale), float(Renderer::Atlas::kTileHeight * wallScale));
+    float du = float(Renderer::Atlas::kTileWidth) / atlas->Width();
+    float dv = float(Renderer::Atlas::kTileHeight) / atlas->Height();
+    for (size_t i = 0; i < machines.size(); ++i) {
+        int column = static_cast<int>(i) % atlas->Columns();
+        int row = static_cast<int>(i) / atlas->Columns();
+        if (column > 0) ImGui::SameLine(0.0f, 2.0f);
+
+        ImGui::Image((void*)(intptr_t)atlasTexture, tileSize, ImVec2(column * du, row * dv), ImVec2((column + 1) * du, (row + 1) * dv));
+        if (ImGui::IsItemClicked()) {
+            Focus(i);
+        }
+        if (ImGui::IsItemHovered()) {
+            const Chip8& machine = machines[i];
+            ImGui::SetTooltip("#%zu  PC %04X%s%s", i, machine.pc, machine.Waiting() ? "  waiting for key" : "",
+                              machine.Trapped() ? "  trapped: " : "", machine.Trapped() ? Chip8::TrapName(machine.trap) : "");
+        }
+        if (&machines[i] == chip8) {
+            ImGui::GetWindowDrawList()->AddRect(ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), ImGui::GetColorU32(labelColor), 0.0f, 0, 2.0f);
+        }
+    }
+
+    ImGui::End();
+}
+
+bool GUI::UploadAtlas(Renderer::Atlas& atlas, GLuint& texture) {
+    auto [first, last] = atlas.TakeDirtyRows();
+    if (texture == 0) {
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlas.Width(), atlas.Height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, atlas.Pixels().data());
+    } else if (first < last) {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, first, atlas.Width(), last - first, GL_RGBA, GL_UNSIGNED_BYTE, atlas.Pixels().data() + size_t(first) * atlas.Width());
+    } else {
+        return false;
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+void GUI::RenderBrowser() {
+    if (!ImGui::Begin("ROM Browser", NULL)) {
+        ImGui::End();
+        return;
+    }
+
+    if (!libraryScanned) {
+        library.Scan(libraryPath);
+        libraryScanned = true;
+    }
+
+    ImGui::PushItemWidth(250);
+    ImGui::InputText("##libraryPath", libraryPath, sizeof(libraryPath));
+    ImGui::PopItemWidth();
+    ImGui::SameLine();
+    if (ImGui::Button("Scan")) {
+        library.Scan(libraryPath);
+    }
+    if (library.Scanning()) {
+        ImGui::SameLine();
+        ImGui::Text("scanning...");
+    }
+
+    // Copy the listing only when the scanner changed it
+    auto options = RenderOptions(1);
+    bool recoloured = options.foreground != libraryOptions.foreground || options.background != libraryOptions.background;
+    if (uint64_t version = library.Version(); version != libraryVersion || recoloured) {
+        libraryVersion = version;
+        libraryEntries = library.Entries();
+        if (!libraryAtlas || libraryAtlas->Tiles() != static_cast<int>(libraryEntries.size())) {
+            libraryAtlas = std::make_unique<Renderer::Atlas>(options, static_cast<int>(libraryEntries.size()), 8);
+            glDeleteTextures(1, &libraryTexture);
+            libraryTexture = 0;
+        } else if (recoloured) {
+            libraryAtlas->Invalidate(options);
+        }
+        libraryOptions = options;
+
+        for (size_t i = 0; i < libraryEntries.size(); ++i) {
+            if (libraryEntries[i].ready) libraryAtlas->Update(static_cast<int>(i), libraryEntries[i].thumbnail);
+        }
+    }
+    if (libraryEntries.empty()) {
+        if (!library.Scanning()) ImGui::Text("No ROMs found");
+        ImGui::End();
+        return;
+    }
+    UploadAtlas(*libraryAtlas, libraryTexture);
+
+    ImGui::BeginChild("Roms");
+    auto thumbnailSize = ImVec2(float(Renderer::Atlas::kTileWidth * 2), float(Renderer::Atlas::kTileHeight * 2));
+    float du = float(Renderer::Atlas::kTileWidth) / libraryAtlas->Width();
+    float dv = float(Renderer::Atlas::kTileHeight) / libraryAtlas->Height();
+    for (size_t i = 0; i < libraryEntries.size(); ++i) {
+        const auto& entry = libraryEntries[i];
+        int column = static_cast<int>(i) % libraryAtlas->Columns();
+        int row = static_cast<int>(i) / libraryAtlas->Columns();
+
+        ImGui::PushID(static_cast<int>(i));
+        ImGui::Image((void*)(intptr_t)libraryTexture, thumbnailSize, ImVec2(column * du, row * dv), ImVec2((column + 1) * du, (row + 1) * dv));
+        bool clicked = ImGui::IsItemClicked();
+        ImGui::SameLine();
+        bool current = entry.path.string() == chip8->Rom().path;
+        clicked |= ImGui::Selectable(entry.title.c_str(), current, 0, ImVec2(0, thumbnailSize.y));
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("%s\n%zu bytes, hash %016llx", entry.path.string().c_str(), entry.size, static_cast<unsigned long long>(entry.hash));
+        }
+        ImGui::PopID();
+
+        if (clicked && !current) {
+            LoadRom(entry.path.string());
+        }
+    }
+    ImGui::EndChild();
+    ImGui::End();
+}
+
+void GUI::RenderPerformance() {
+    if (!ImGui::Begin("Performance", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::End();
+        return;
+    }
+
+    auto plot = [&](const char* label, const std::array<float, kFrameHistory>& history) {
+        float total = 0.0f;
+        float worst = 0.0f;
+        for (float ms : history) {
+            total += ms;
+            worst = std::max(worst, ms);
+        }
+
+        char overlay[64];
+        snprintf(overlay, sizeof(overlay), "avg %.2f ms, max %.2f ms", total / kFrameHistory, worst);
+        ImGui::PlotLines(label, history.data(), kFrameHistory, frameHistoryOffset, overlay, 0.0f, std::max(worst, 1.0f), ImVec2(260, 40));
+    };
+
+    plot("Frame", frameTimes);
+    plot("Emulation", emulationTimes);
+    plot("Run-ahead", runAheadTimes);
+    plot("Upload", uploadTimes);
+    plot("UI", uiTimes);
+    ImGui::Separator();
+
+    // Key edge to the first changed display, and on to the buffer swap that shows it
+    auto histogram = [](const char* label, const Histogram& h) {
+        std::vector<float> counts(h.Buckets().begin(), h.Buckets().end());
+        char overlay[96];
+        if (h.Count() == 0) {
+            snprintf(overlay, sizeof(overlay), "no samples");
+        } else {
+            snprintf(overlay, sizeof(overlay), "p50 %.1f, p95 %.1f, p99 %.1f ms (%llu)",
+                h.Percentile(50), h.Percentile(95), h.Percentile(99), static_cast<unsigned long long>(h.Count()));
+        }
+        ImGui::PlotHistogram(label, counts.data(), static_cast<int>(counts.size()), 0, overlay, 0.0f, FLT_MAX, ImVec2(260, 40));
+    };
+
+    ImGui::Text("Input latency (%.0f ms buckets, last is overflow)", latency.ToDisplay().BucketWidth());
+    histogram("To display", latency.ToDisplay());
+    histogram("To present", latency.ToPresent());
+    ImGui::Text("Unanswered key edges: %llu", static_cast<unsigned long long>(latency.Unanswered()));
+    if (ImGui::Button("Reset latency")) {
+        latency.Clear();
+    }
+    ImGui::Separator();
+
+    ImGui::PushItemWidth(150);
+    ImGui::SliderInt("Panel refresh (Hz)", &panelRefreshRate, 0, 60, panelRefreshRate == 0 ? "every frame" : "%d");
+    ImGui::PopItemWidth();
+
+    ImGui::End();
+}
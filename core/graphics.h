@@ -1,40 +1,161 @@
 #pragma once
 
+#include <array>
 #include <chrono>
+#include <future>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
 #include <GLFW/glfw3.h>
 #include <imgui.h>
 #include <imgui_memory_editor/imgui_memory_editor.h>
+#include "catalog.h"
 #include "chip8.h"
+#include "debugger.h"
+#include "latency.h"
+#include "library.h"
+#include "metrics.h"
+#include "renderer.h"
+#include "runahead.h"
 
-using high_resolution_time_point = std::chrono::time_point<std::chrono::steady_clock, std::chrono::duration<long long, std::ratio<1, 1000000000>>>;
+using steady_time_point = std::chrono::steady_clock::time_point;
 class Chip8;
 
 class GUI {
 public:
-    GUI(Chip8* chip8, GLuint displayTexture, GLubyte* displayPixels, GLFWwindow* window);
+    // All machines run together; the debug panels follow the focused one (the first to begin with)
+    GUI(std::span<Chip8> machines, GLuint displayTexture, uint32_t* displayPixels, GLFWwindow* window);
     void Render();
+    // True while nothing changes on its own (paused), so the main loop can block on events
+    bool IsIdle() const;
+    // Call right after the buffer swap, closes the present stage of a pending latency measurement
+    void Presented();
     int kDisplayScale = 15;
 
 private:
+    std::span<Chip8> machines;
     Chip8* chip8;
     GLuint displayTexture;
-    GLubyte* displayPixels;
+    uint32_t* displayPixels;
     GLFWwindow* window;
 
+    // Host key for each Chip-8 key, see the table at the end of this file
+    std::array<int, 16> keymap = {
+        GLFW_KEY_X,                         // |       | X (0) |       |       |
+        GLFW_KEY_1, GLFW_KEY_2, GLFW_KEY_3, // | 1 (1) | 2 (2) | 3 (3) |       |
+        GLFW_KEY_Q, GLFW_KEY_W, GLFW_KEY_E, // | Q (4) | W (5) | E (6) |       |
+        GLFW_KEY_A, GLFW_KEY_S, GLFW_KEY_D, // | A (7) | S (8) | D (9) |       |
+        GLFW_KEY_Z, GLFW_KEY_C,             // | Z (A) |       | C (B) |       |
+        GLFW_KEY_4,                         // |       |       |       | 4 (C) |
+        GLFW_KEY_R,                         // |       |       |       | R (D) |
+        GLFW_KEY_F,                         // |       |       |       | F (E) |
+        GLFW_KEY_V,                         // |       |       |       | V (F) |
+    };
+
     // RGBA
     ImVec4 foregroundColour = ImVec4(1.0f, 0.0f, 0.0f, 1.0f);
     ImVec4 backgroundColour = ImVec4(0.047f, 0.047f, 0.047f, 1.0f);
     ImVec4 labelColor = ImVec4(1.0f, 0.3f, 0.3f, 1.0f);
     ImVec4 successColor = ImVec4(0.0f, 1.0f, 0.0f, 1.0f);
 
-    high_resolution_time_point lastTimer = std::chrono::high_resolution_clock::now();
+    steady_time_point lastTimer = std::chrono::steady_clock::now();
+
+    // Frame-time breakdown shown in the Performance window, in milliseconds
+    static constexpr int kFrameHistory = 240;
+    std::array<float, kFrameHistory> emulationTimes = { 0 };
+    std::array<float, kFrameHistory> uploadTimes = { 0 };
+    std::array<float, kFrameHistory> uiTimes = { 0 };
+    std::array<float, kFrameHistory> runAheadTimes = { 0 };
+    std::array<float, kFrameHistory> frameTimes = { 0 };
+    int frameHistoryOffset = 0;
+    float emulationTime = 0.0f;
+    float uploadTime = 0.0f;
+    float runAheadTime = 0.0f;
+    steady_time_point lastFrame = std::chrono::steady_clock::now();
+
+    // The focused machine is presented runAhead.Frames() frames early while running without a
+    // debugger. It and the quirk profile of all machines are remembered per ROM in the catalog
+    // (RomCatalog::DefaultPath()); a ROM the catalog doesn't know yet runs with the default
+    // profile while it is classified in the background.
+    static constexpr int kMaxRunAhead = 8;
+    RunAhead runAhead;
+    RomCatalog catalog;
+    uint64_t romHash = 0;
+    Profile quirksProfile = Profile::Default;
+    bool presentedAhead = false;
+
+    struct PendingClassification {
+        uint64_t hash;
+        std::string title;
+        std::future<Profile> profile;
+    };
+    std::vector<PendingClassification> classifications;
+
+    // Input-to-display latency of the focused machine in wall-clock milliseconds, 2 ms buckets up to 100 ms
+    LatencyProbe latency{ 2.0, 50 };
+
+    // Wall view of every machine, packed into one atlas texture that is uploaded once a frame
+    std::unique_ptr<Renderer::Atlas> atlas;
+    Renderer::Options atlasOptions;
+    GLuint atlasTexture = 0;
+    int wallScale = 2;
+
+    // ROM browser, listed and thumbnailed in the background and drawn from its own atlas
+    RomLibrary library;
+    std::vector<RomLibrary::Entry> libraryEntries;
+    uint64_t libraryVersion = 0;
+    bool libraryScanned = false;
+    char libraryPath[256] = ".";
+    std::unique_ptr<Renderer::Atlas> libraryAtlas;
+    Renderer::Options libraryOptions;
+    GLuint libraryTexture = 0;
+
+    // Debug panels draw from a snapshot refreshed at most panelRefreshRate times a second (0 = every frame)
+    int panelRefreshRate = 30;
+
+    // Screenshots are rendered on the CPU at the display scale, independent of the GL texture
+    int screenshotFilter = 0;
+    char screenshotPath[256] = "screenshot.png";
+    steady_time_point lastPanelRefresh;
+    Chip8::State panel = {};
+
+    // Disassembler text is only rebuilt when the pc or the memory generation of the snapshot change
+    std::vector<std::string> disassemblyLines;
+    uint64_t panelGeneration = 0;
+    uint64_t disassemblyGeneration = 0;
+    int disassemblyStart = -1;
+    int disassemblyPc = -1;
+
+    // Same counters the headless runner and server export; the General panel reads them
+    MetricsRegistry metricsRegistry;
+    InstanceMetrics& metrics = metricsRegistry.Add("gui");
 
-    int ticks = 0;
     bool tickRequested = false;
     int clockSpeed = 960;
     int prevClockSpeed = clockSpeed;
 
+    // Breakpoints and watchpoints, attached to chip8 only while any are set
+    Debugger debugger;
+    int watchAddress = 0x200;
+    bool watchRead = false;
+    bool watchWrite = true;
+    int conditionRegister = 0;
+    int conditionValue = 0;
+
     void Tick(GLFWwindow* window);
+    void Focus(size_t instance);
+    // Replaces the program of every machine without restarting, false if the file can't be loaded
+    bool LoadRom(const std::string& path);
+    // Resets every machine onto the image, each with its own random stream
+    void Boot(std::shared_ptr<const RomImage> image);
+    void PollKeypad(GLFWwindow* window);
+    // Looks up the loaded ROM in the catalog and applies its settings, then the baked boot of a bundled ROM
+    void ApplyCatalog();
+    // Stores finished classifications, and restarts the loaded ROM if its profile turned out not to be the default
+    void PollClassifications();
+    void Pause();
+    void Resume();
     void RenderDisplay(float framerate);
     void RenderRom();
     void RenderDisassembler();
@@ -44,9 +165,29 @@ private:
     void RenderMemory();
     void RenderKeypadState();
     void RenderStack();
+    void RenderPerformance();
+    void RenderWall();
+    void RenderBrowser();
+    // Creates the texture on first use, then uploads the rows that changed; true if anything was uploaded
+    bool UploadAtlas(Renderer::Atlas& atlas, GLuint& texture);
+    // Current FG/BG colours at the given scale, for the CPU renderer
+    Renderer::Options RenderOptions(int scale) const;
+    void SaveScreenshot();
+    void RefreshPanels(steady_time_point now);
 
     std::string DisassembleOpcode(uint16_t opcode, int address);
 
 
     MemoryEditor memoryEditor;
 };
+
+/*
+    ------------------------------------------------
+    |   Chip 8 Keyboard    |     Keyboard Map      |
+    ------------------------------------------------
+    |   1    2    3    C   |    1    2    3    4   |
+    |   4    5    6    D   |    Q    W    E    R   |
+    |   7    8    9    E   |    A    S    D    F   |
+    |   A    0    B    F   |    Z    X    C    V   |
+    ------------------------------------------------
+*/
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include "chip8.h"
+
+// 64-bit FNV-1a, used to compare machine state and framebuffers without keeping copies
+constexpr uint64_t kFnvOffset = 0xCBF29CE484222325ull;
+constexpr uint64_t kFnvPrime = 0x100000001B3ull;
+
+inline uint64_t Fnv1a(std::span<const uint8_t> bytes, uint64_t hash = kFnvOffset) {
+    for (uint8_t byte : bytes) {
+        hash = (hash ^ byte) * kFnvPrime;
+    }
+    return hash;
+}
+
+// Hashes an unsigned integer as little-endian bytes, so hashes match across hosts
+template <typename T>
+inline uint64_t Fnv1aValue(T value, uint64_t hash = kFnvOffset) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        hash = (hash ^ static_cast<uint8_t>(value >> (i * 8))) * kFnvPrime;
+    }
+    return hash;
+}
+
+inline uint64_t HashDisplay(const Chip8::Display& display) {
+    return Fnv1a(display);
+}
+
+// Hash of the program bytes as loaded from the file, the same value RomLibrary computes from disk
+inline uint64_t HashRom(const RomImage& image) {
+    uint64_t hash = kFnvOffset;
+    for (size_t address = Chip8::kStartAddress; address < Chip8::kStartAddress + image.size; ++address) {
+        hash = (hash ^ image[address]) * kFnvPrime;
+    }
+    return hash;
+}
+
+inline uint64_t HashMemory(const std::array<uint8_t, 4096>& memory) {
+    return Fnv1a(memory);
+}
+
+inline uint64_t HashMemory(const Memory& memory) {
+    std::array<uint8_t, 4096> bytes;
+    memory.CopyTo(bytes);
+    return Fnv1a(bytes);
+}
+
+// Everything execution depends on, field by field so struct padding never leaks into the hash
+inline uint64_t HashState(const Chip8::State& state) {
+    uint64_t hash = Fnv1a(state.memory);
+    hash = Fnv1a(state.registers, hash);
+    for (uint16_t entry : state.stack) hash = Fnv1aValue(entry, hash);
+    hash = Fnv1a(state.display, hash);
+    hash = Fnv1a(state.keypad, hash);
+    hash = Fnv1aValue(state.sp, hash);
+    hash = Fnv1aValue(state.pc, hash);
+    hash = Fnv1aValue(state.index, hash);
+    hash = Fnv1aValue(state.delayTimer, hash);
+    hash = Fnv1aValue(state.soundTimer, hash);
+    hash = Fnv1aValue(static_cast<uint8_t>(state.cpuState), hash);
+    hash = Fnv1aValue(state.waitRegister, hash);
+    hash = Fnv1aValue(static_cast<uint8_t>(state.waitKey), hash);
+    hash = Fnv1aValue(state.waitHeld, hash);
+    hash = Fnv1aValue(static_cast<uint8_t>(state.trap), hash);
+    for (uint32_t word : state.rng) hash = Fnv1aValue(word, hash);
+    return hash;
+}
@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include "image.h"
+
+namespace {
+
+std::FILE* OpenOutput(std::string_view path) {
+    std::FILE* file = std::fopen(std::string(path).c_str(), "wb");
+    if (!file) {
+        std::cerr << "Failed to open image output: " << path << std::endl;
+    }
+    return file;
+}
+
+uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+    static const auto table = [] {
+        std::array<uint32_t, 256> entries;
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            entries[n] = c;
+        }
+        return entries;
+    }();
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void Put32(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(value >> 24);
+    out.push_back(value >> 16);
+    out.push_back(value >> 8);
+    out.push_back(value);
+}
+
+void WriteChunk(std::FILE* file, const char type[4], const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> chunk;
+    chunk.reserve(data.size() + 12);
+    Put32(chunk, static_cast<uint32_t>(data.size()));
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    Put32(chunk, Crc32(chunk.data() + 4, data.size() + 4));
+    std::fwrite(chunk.data(), 1, chunk.size(), file);
+}
+
+// zlib stream made of stored (uncompressed) deflate blocks
+std::vector<uint8_t> Store(const std::vector<uint8_t>& raw) {
+    constexpr size_t kBlock = 65535;
+
+    std::vector<uint8_t> out = { 0x78, 0x01 };
+    out.reserve(raw.size() + raw.size() / kBlock * 5 + 16);
+    size_t at = 0;
+    do {
+        size_t size = std::min(kBlock, raw.size() - at);
+        bool last = at + size == raw.size();
+        out.push_back(last ? 1 : 0);
+        out.push_back(size & 0xFF);
+        out.push_back(size >> 8);
+        out.push_back(~size & 0xFF);
+        out.push_back((~size >> 8) & 0xFF);
+        out.insert(out.end(), raw.begin() + at, raw.begin() + at + size);
+        at += size;
+    } while (at < raw.size());
+
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : raw) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    Put32(out, b << 16 | a);
+    return out;
+}
+
+} // namespace
+
+bool WritePpm(std::string_view path, const uint32_t* pixels, int width, int height) {
+    std::FILE* file = OpenOutput(path);
+    if (!file) return false;
+
+    std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+    std::vector<uint8_t> row(size_t(width) * 3);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            uint32_t pixel = pixels[size_t(y) * width + x];
+            row[x * 3] = pixel & 0xFF;
+            row[x * 3 + 1] = (pixel >> 8) & 0xFF;
+            row[x * 3 + 2] = (pixel >> 16) & 0xFF;
+        }
+        std::fwrite(row.data(), 1, row.size(), file);
+    }
+    return std::fclose(file) == 0;
+}
+
+bool WritePng(std::string_view path, const uint32_t* pixels, int width, int height) {
+    size_t count = size_t(width) * height;
+
+    // Index the colours; fall back to RGBA past 256 of them
+    std::unordered_map<uint32_t, uint8_t> palette;
+    std::vector<uint32_t> colours;
+    for (size_t i = 0; i < count && colours.size() <= 256; ++i) {
+        if (palette.try_emplace(pixels[i], static_cast<uint8_t>(colours.size())).second) {
+            colours.push_back(pixels[i]);
+        }
+    }
+    bool indexed = colours.size() <= 256;
+
+    int channels = indexed ? 1 : 4;
+    std::vector<uint8_t> raw;
+    raw.reserve((size_t(width) * channels + 1) * height);
+    for (int y = 0; y < height; ++y) {
+        raw.push_back(0); // filter: none
+        for (int x = 0; x < width; ++x) {
+            uint32_t pixel = pixels[size_t(y) * width + x];
+            if (indexed) {
+                raw.push_back(palette[pixel]);
+            } else {
+                raw.push_back(pixel & 0xFF);
+                raw.push_back((pixel >> 8) & 0xFF);
+                raw.push_back((pixel >> 16) & 0xFF);
+                raw.push_back(pixel >> 24);
+            }
+        }
+    }
+
+    std::FILE* file = OpenOutput(path);
+    if (!file) return false;
+
+    static constexpr uint8_t kSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    std::fwrite(kSignature, 1, sizeof(kSignature), file);
+
+    std::vector<uint8_t> header;
+    Put32(header, width);
+    Put32(header, height);
+    header.push_back(8);                  // bit depth
+    header.push_back(indexed ? 3 : 6);    // palette or RGBA
+    header.push_back(0);                  // deflate
+    header.push_back(0);                  // adaptive filtering
+    header.push_back(0);                  // no interlace
+    WriteChunk(file, "IHDR", header);
+
+    if (indexed) {
+        std::vector<uint8_t> plte;
+        std::vector<uint8_t> trns;
+        bool transparent = false;
+        for (uint32_t colour : colours) {
+            plte.push_back(colour & 0xFF);
+            plte.push_back((colour >> 8) & 0xFF);
+            plte.push_back((colour >> 16) & 0xFF);
+            trns.push_back(colour >> 24);
+            transparent |= (colour >> 24) != 0xFF;
+        }
+        WriteChunk(file, "PLTE", plte);
+        if (transparent) WriteChunk(file, "tRNS", trns);
+    }
+
+    WriteChunk(file, "IDAT", Store(raw));
+    WriteChunk(file, "IEND", {});
+    return std::fclose(file) == 0;
+}
+
+bool WriteImage(std::string_view path, const uint32_t* pixels, int width, int height) {
+    return path.ends_with(".png") ? WritePng(path, pixels, width, height) : WritePpm(path, pixels, width, height);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Screenshot writers for RGBA pixel buffers (R in the lowest byte), no external libraries.
+//
+// PNG output uses uncompressed deflate blocks: images with at most 256 colours (every Chip-8
+// screenshot, filters included) are written as 8-bit palette images, others as RGBA.
+
+bool WritePpm(std::string_view path, const uint32_t* pixels, int width, int height);
+bool WritePng(std::string_view path, const uint32_t* pixels, int width, int height);
+
+// Picks PNG for *.png paths and PPM for everything else
+bool WriteImage(std::string_view path, const uint32_t* pixels, int width, int height);
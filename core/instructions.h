@@ -5,145 +5,181 @@
 #include "opcode.h"
 
 // 00E0 - Clear the display.
-void CLS(Chip8* chip8) {
+template <typename Machine>
+constexpr void CLS(Machine* chip8) {
     chip8->display.fill(0);
 }
 
 // 00EE - Return from a subroutine.
-void RET(Chip8* chip8) {
-    if (chip8->sp > 0) {
-        chip8->pc = chip8->stack[--chip8->sp];
-    }
-    else {
-        std::cerr << "Stack underflow error!" << std::endl;
-        abort();
+template <typename Machine>
+constexpr void RET(Machine* chip8) {
+    if (chip8->sp == 0) [[unlikely]] {
+        chip8->Raise(Chip8::Trap::StackUnderflow, chip8->pc - 2);
+        return;
     }
+    chip8->pc = chip8->stack[--chip8->sp];
 }
 
 // 1nnn - Jump to location nnn.
-void JMP(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void JMP(Opcode in, Machine* chip8) {
     chip8->pc = in.address();
 }
 
 // 2nnn - Call subroutine at nnn.
-void CALL(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void CALL(Opcode in, Machine* chip8) {
+    if (chip8->sp >= chip8->stack.size()) [[unlikely]] {
+        chip8->Raise(Chip8::Trap::StackOverflow, chip8->pc - 2);
+        return;
+    }
     chip8->stack[chip8->sp++] = chip8->pc;
     chip8->pc = in.address();
 }
 
 // 3xkk - Skip next instruction if Vx = kk.
-void SE_VX_KK(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void SE_VX_KK(Opcode in, Machine* chip8) {
     if (chip8->registers[in.x()] == in.byte()) {
         chip8->pc += 2;
     }
 }
 
 // 4xkk - Skip next instruction if Vx != kk.
-void SNE_VX_KK(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void SNE_VX_KK(Opcode in, Machine* chip8) {
     if (chip8->registers[in.x()] != in.byte()) {
         chip8->pc += 2;
     }
 }
 
 // 5xy0 - Skip next instruction if Vx = Vy.
-void SE_VX_VY(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void SE_VX_VY(Opcode in, Machine* chip8) {
     if (chip8->registers[in.x()] == chip8->registers[in.y()]) {
         chip8->pc += 2;
     }
 }
 
 // 6xkk - The interpreter puts the value kk into register Vx.
-void LD_VX_KK(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void LD_VX_KK(Opcode in, Machine* chip8) {
     chip8->registers[in.x()] = in.byte();
 }
 
 // 7xkk - Adds the value kk to the value of register Vx.
-void ADD_VX_KK(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void ADD_VX_KK(Opcode in, Machine* chip8) {
     chip8->registers[in.x()] += in.byte();
 }
 
 // 8xy0 - Stores the value of register Vy in register Vx.
-void LD_VX_VY(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void LD_VX_VY(Opcode in, Machine* chip8) {
     chip8->registers[in.x()] = chip8->registers[in.y()];
 }
 
 // 8xy1 - Performs a bitwise OR on the values of Vx and Vy.
-void OR_VX_VY(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void OR_VX_VY(Opcode in, Machine* chip8) {
     chip8->registers[in.x()] |= chip8->registers[in.y()];
+    if (chip8->quirks.vfReset) chip8->registers[0x0F] = 0;
 }
 
 // 8xy2 - Performs a bitwise AND on the values of Vx and Vy.
-void AND_VX_VY(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void AND_VX_VY(Opcode in, Machine* chip8) {
     chip8->registers[in.x()] &= chip8->registers[in.y()];
+    if (chip8->quirks.vfReset) chip8->registers[0x0F] = 0;
 }
 
 // 8xy3 - Performs a bitwise exclusive OR on the values of Vx and Vy.
-void XOR_VX_VY(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void XOR_VX_VY(Opcode in, Machine* chip8) {
     chip8->registers[in.x()] ^= chip8->registers[in.y()];
+    if (chip8->quirks.vfReset) chip8->registers[0x0F] = 0;
 }
 
 // 8xy4 - Set Vx = Vx + Vy, set VF = carry.
-void ADD_VX_VY(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void ADD_VX_VY(Opcode in, Machine* chip8) {
     uint16_t sum = chip8->registers[in.x()] + chip8->registers[in.y()];
     chip8->registers[0x0F] = sum > 0xFF ? 1 : 0;
     chip8->registers[in.x()] = sum & 0xFF;
 }
 
 // 8xy5 - Set Vx = Vx - Vy, set VF = NOT borrow.
-void SUB_VX_VY(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void SUB_VX_VY(Opcode in, Machine* chip8) {
     chip8->registers[0x0F] = chip8->registers[in.x()] > chip8->registers[in.y()] ? 1 : 0;
     chip8->registers[in.x()] -= chip8->registers[in.y()];
 }
 
-// 8xy6 - Set Vx = Vx SHR 1.
-void SHR_VX(Opcode in, Chip8* chip8) {
-    chip8->registers[0x0F] = chip8->registers[in.x()] & 0x01;
-    chip8->registers[in.x()] >>= 1;
+// 8xy6 - Set Vx = Vx SHR 1 (Vy SHR 1 with quirks.shiftVy).
+template <typename Machine>
+constexpr void SHR_VX(Opcode in, Machine* chip8) {
+    uint8_t value = chip8->registers[chip8->quirks.shiftVy ? in.y() : in.x()];
+    chip8->registers[0x0F] = value & 0x01;
+    chip8->registers[in.x()] = value >> 1;
 }
 
 // 8xy7 - Set Vx = Vy - Vx, set VF = NOT borrow.
-void SUBN_VX_VY(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void SUBN_VX_VY(Opcode in, Machine* chip8) {
     chip8->registers[0x0F] = chip8->registers[in.y()] > chip8->registers[in.x()] ? 1 : 0;
     chip8->registers[in.x()] = chip8->registers[in.y()] - chip8->registers[in.x()];
 }
 
-// 8xyE - Set Vx = Vx SHL 1.
-void SHL_VX(Opcode in, Chip8* chip8) {
-    chip8->registers[0x0F] = chip8->registers[in.x()] >> 7;
-    chip8->registers[in.x()] <<= 1;
+// 8xyE - Set Vx = Vx SHL 1 (Vy SHL 1 with quirks.shiftVy).
+template <typename Machine>
+constexpr void SHL_VX(Opcode in, Machine* chip8) {
+    uint8_t value = chip8->registers[chip8->quirks.shiftVy ? in.y() : in.x()];
+    chip8->registers[0x0F] = value >> 7;
+    chip8->registers[in.x()] = value << 1;
 }
 
 // 9xy0 - Skip next instruction if Vx != Vy.
-void SNE_VX_VY(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void SNE_VX_VY(Opcode in, Machine* chip8) {
     if (chip8->registers[in.x()] != chip8->registers[in.y()]) {
         chip8->pc += 2;
     }
 }
 
 // Annn - Register I is set to nnn.
-void LD_I(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void LD_I(Opcode in, Machine* chip8) {
     chip8->index = in.address();
 }
 
-// Bnnn - Program counter is set to nnn plus the value of V0.
-void JP_V0(Opcode in, Chip8* chip8) {
-    chip8->pc = in.address() + chip8->registers[0x00];
+// Bnnn - Program counter is set to nnn plus the value of V0 (Vx with quirks.jumpVx).
+template <typename Machine>
+constexpr void JP_V0(Opcode in, Machine* chip8) {
+    chip8->pc = in.address() + chip8->registers[chip8->quirks.jumpVx ? in.x() : 0x00];
 }
 
 // Cxkk - Set Vx = random byte AND kk
-void RND(Opcode in, Chip8* chip8, Random* rand) {
+template <typename Machine, typename Rng>
+constexpr void RND(Opcode in, Machine* chip8, Rng* rand) {
     chip8->registers[in.x()] = (*rand)() & in.byte();
 }
 
 // Dxyn - Display n-byte sprite starting at memory location I at (Vx, Vy), set VF = collision.
-void DRW(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void DRW(Opcode in, Machine* chip8) {
+    if (chip8->debugger) chip8->debugger->OnRead(chip8->index, in.low());
+    chip8->counters.draws++;
     chip8->registers[0x0F] = 0;
     for (int y = 0; y < in.low(); ++y) {
         uint8_t sprite_byte = chip8->memory[chip8->index + y];
         for (int x = 0; x < 8; ++x) {
             if (sprite_byte & (0x80 >> x)) {
-                uint16_t px = (chip8->registers[in.x()] + x) % Chip8::kWidth;
-                uint16_t py = (chip8->registers[in.y()] + y) % Chip8::kHeight;
+                // The start position always wraps, only the pixels past an edge are clipped
+                uint16_t px = chip8->registers[in.x()] % Chip8::kWidth + x;
+                uint16_t py = chip8->registers[in.y()] % Chip8::kHeight + y;
+                if (chip8->quirks.clipSprites && (px >= Chip8::kWidth || py >= Chip8::kHeight)) continue;
+                px %= Chip8::kWidth;
+                py %= Chip8::kHeight;
                 uint16_t pixel = px + py * Chip8::kWidth;
                 if (chip8->display[pixel]) chip8->registers[0x0F] = 1;
                 chip8->display[pixel] ^= 1;
@@ -155,71 +191,255 @@ void DRW(Opcode in, Chip8* chip8) {
 
 
 // Ex9E - Skip instruction if key with the value of Vx is pressed.
-void SKP(Opcode in, Chip8* chip8, GLFWwindow* window) {
-    if (chip8->IsPressed(window, chip8->registers[in.x()])) {
+template <typename Machine>
+constexpr void SKP(Opcode in, Machine* chip8) {
+    if (chip8->IsPressed(chip8->registers[in.x()])) {
         chip8->pc += 2;
     }
 }
 
 // ExA1 - Skip instruction if key with the value of Vx is not pressed.
-void SKNP(Opcode in, Chip8* chip8, GLFWwindow* window) {
-    if (!chip8->IsPressed(window, chip8->registers[in.x()])) {
+template <typename Machine>
+constexpr void SKNP(Opcode in, Machine* chip8) {
+    if (!chip8->IsPressed(chip8->registers[in.x()])) {
         chip8->pc += 2;
     }
 }
 
 // Fx07 - Set Vx = delay timer value.
-void LD_VX_DT(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void LD_VX_DT(Opcode in, Machine* chip8) {
     chip8->registers[in.x()] = chip8->delayTimer;
 }
 
 // Fx0A - Wait for a key press, store the value of the key in Vx.
-void LD_VX_K(Opcode in, Chip8* chip8, GLFWwindow* window) {
-    for (auto i = 0; i < 0x0F; ++i) {
-        if (chip8->IsPressed(window, i)) {
-            chip8->registers[in.x()] = i;
-        }
-    }
+template <typename Machine>
+constexpr void LD_VX_K(Opcode in, Machine* chip8) {
+    chip8->WaitForKey(in.x());
 }
 
 // Fx15 - Set delay timer = Vx.
-void LD_DT(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void LD_DT(Opcode in, Machine* chip8) {
     chip8->delayTimer = chip8->registers[in.x()];
 }
 
 // Fx18 - Set sound timer = Vx.
-void LD_ST(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void LD_ST(Opcode in, Machine* chip8) {
     chip8->soundTimer = chip8->registers[in.x()];
 }
 
 // Fx1E - Set I = I + Vx.
-void ADD_I_VX(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void ADD_I_VX(Opcode in, Machine* chip8) {
     chip8->index += chip8->registers[in.x()];
 }
 
 // Fx29 - Set I = location of sprite for digit Vx.
-void LD_F_VX(Opcode in, Chip8* chip8) {
-    // Sprites start at 0x00 and the size of each sprite is 5 bytes
-    chip8->index = chip8->registers[in.x()] * 0x05;
+template <typename Machine>
+constexpr void LD_F_VX(Opcode in, Machine* chip8) {
+    // The font is loaded at 0x50 (Chip8::CreateImage) and each sprite is 5 bytes
+    chip8->index = 0x50 + (chip8->registers[in.x()] & 0x0F) * 0x05;
 }
 
 // Fx33 - Store BCD representation of Vx in memory locations I, I+1, and I+2.
-void LD_B_VX(Opcode in, Chip8* chip8) {
-    chip8->memory[chip8->index] = chip8->registers[in.x()] / 100;
-    chip8->memory[chip8->index + 1] = (chip8->registers[in.x()] / 10) % 10;
-    chip8->memory[chip8->index + 2] = chip8->registers[in.x()] % 10;
+template <typename Machine>
+constexpr void LD_B_VX(Opcode in, Machine* chip8) {
+    if (chip8->index + 2 > 0xFFF) [[unlikely]] {
+        chip8->Raise(Chip8::Trap::OutOfRange, chip8->pc - 2);
+        return;
+    }
+    if (chip8->debugger) chip8->debugger->OnWrite(chip8->index, 3);
+    chip8->memory.Write(chip8->index, chip8->registers[in.x()] / 100);
+    chip8->memory.Write(chip8->index + 1, (chip8->registers[in.x()] / 10) % 10);
+    chip8->memory.Write(chip8->index + 2, chip8->registers[in.x()] % 10);
 }
 
 // Fx55 - Store regs V0 through Vx in memory starting at location I.
-void LD_I_VX(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void LD_I_VX(Opcode in, Machine* chip8) {
+    if (chip8->index + in.x() > 0xFFF) [[unlikely]] {
+        chip8->Raise(Chip8::Trap::OutOfRange, chip8->pc - 2);
+        return;
+    }
+    if (chip8->debugger) chip8->debugger->OnWrite(chip8->index, in.x() + 1);
     for (uint8_t i = 0; i <= in.x(); ++i) {
-        chip8->memory[chip8->index + i] = chip8->registers[i];
+        chip8->memory.Write(chip8->index + i, chip8->registers[i]);
     }
+    if (chip8->quirks.memoryIncrement) chip8->index += in.x() + 1;
 }
 
 // Fx65 - Read regs V0 through Vx from memory starting at location I.
-void LD_VX_I(Opcode in, Chip8* chip8) {
+template <typename Machine>
+constexpr void LD_VX_I(Opcode in, Machine* chip8) {
+    if (chip8->index + in.x() > 0xFFF) [[unlikely]] {
+        chip8->Raise(Chip8::Trap::OutOfRange, chip8->pc - 2);
+        return;
+    }
+    if (chip8->debugger) chip8->debugger->OnRead(chip8->index, in.x() + 1);
     for (uint8_t i = 0; i <= in.x(); ++i) {
         chip8->registers[i] = chip8->memory[chip8->index + i];
     }
+    if (chip8->quirks.memoryIncrement) chip8->index += in.x() + 1;
+}
+
+// 5xy2 - Store Vx through Vy (either direction) in memory starting at location I, I unchanged (XO-CHIP).
+template <typename Machine>
+constexpr void SAVE_VX_VY(Opcode in, Machine* chip8) {
+    int step = in.x() <= in.y() ? 1 : -1;
+    int count = (in.x() <= in.y() ? in.y() - in.x() : in.x() - in.y()) + 1;
+    if (chip8->index + count - 1 > 0xFFF) [[unlikely]] {
+        chip8->Raise(Chip8::Trap::OutOfRange, chip8->pc - 2);
+        return;
+    }
+    if (chip8->debugger) chip8->debugger->OnWrite(chip8->index, count);
+    for (int i = 0; i < count; ++i) {
+        chip8->memory.Write(chip8->index + i, chip8->registers[in.x() + i * step]);
+    }
+}
+
+// 5xy3 - Load Vx through Vy (either direction) from memory starting at location I, I unchanged (XO-CHIP).
+template <typename Machine>
+constexpr void LOAD_VX_VY(Opcode in, Machine* chip8) {
+    int step = in.x() <= in.y() ? 1 : -1;
+    int count = (in.x() <= in.y() ? in.y() - in.x() : in.x() - in.y()) + 1;
+    if (chip8->index + count - 1 > 0xFFF) [[unlikely]] {
+        chip8->Raise(Chip8::Trap::OutOfRange, chip8->pc - 2);
+        return;
+    }
+    if (chip8->debugger) chip8->debugger->OnRead(chip8->index, count);
+    for (int i = 0; i < count; ++i) {
+        chip8->registers[in.x() + i * step] = chip8->memory[chip8->index + i];
+    }
+}
+
+// Executes one decoded instruction on anything with Chip8's members: the interpreter at run time,
+// BootMachine in constant expressions. pc is already past the instruction and opcode holds it.
+template <typename Machine>
+constexpr void ExecuteInstruction(Machine* chip8, Instruction instruction) {
+    Opcode opcode = chip8->opcode;
+    switch (instruction) {
+        case Instruction::CLS: return CLS(chip8);
+        case Instruction::RET: return RET(chip8);
+        case Instruction::JMP: return JMP(opcode, chip8);
+        case Instruction::CALL: return CALL(opcode, chip8);
+        case Instruction::SE_VX_KK: return SE_VX_KK(opcode, chip8);
+        case Instruction::SNE_VX_KK: return SNE_VX_KK(opcode, chip8);
+        case Instruction::SE_VX_VY: return SE_VX_VY(opcode, chip8);
+        case Instruction::LD_VX_KK: return LD_VX_KK(opcode, chip8);
+        case Instruction::ADD_VX_KK: return ADD_VX_KK(opcode, chip8);
+        case Instruction::LD_VX_VY: return LD_VX_VY(opcode, chip8);
+        case Instruction::OR_VX_VY: return OR_VX_VY(opcode, chip8);
+        case Instruction::AND_VX_VY: return AND_VX_VY(opcode, chip8);
+        case Instruction::XOR_VX_VY: return XOR_VX_VY(opcode, chip8);
+        case Instruction::ADD_VX_VY: return ADD_VX_VY(opcode, chip8);
+        case Instruction::SUB_VX_VY: return SUB_VX_VY(opcode, chip8);
+        case Instruction::SHR_VX: return SHR_VX(opcode, chip8);
+        case Instruction::SUBN_VX_VY: return SUBN_VX_VY(opcode, chip8);
+        case Instruction::SHL_VX: return SHL_VX(opcode, chip8);
+        case Instruction::SNE_VX_VY: return SNE_VX_VY(opcode, chip8);
+        case Instruction::LD_I: return LD_I(opcode, chip8);
+        case Instruction::JMP_V0: return JP_V0(opcode, chip8);
+        case Instruction::RND: return RND(opcode, chip8, &chip8->rand);
+        case Instruction::DRW: return DRW(opcode, chip8);
+        case Instruction::SKP: return SKP(opcode, chip8);
+        case Instruction::SKNP: return SKNP(opcode, chip8);
+        case Instruction::LD_VX_DT: return LD_VX_DT(opcode, chip8);
+        case Instruction::LD_VX_K: return LD_VX_K(opcode, chip8);
+        case Instruction::LD_DT: return LD_DT(opcode, chip8);
+        case Instruction::LD_ST: return LD_ST(opcode, chip8);
+        case Instruction::ADD_I_VX: return ADD_I_VX(opcode, chip8);
+        case Instruction::LD_F_VX: return LD_F_VX(opcode, chip8);
+        case Instruction::LD_B_VX: return LD_B_VX(opcode, chip8);
+        case Instruction::LD_I_VX: return LD_I_VX(opcode, chip8);
+        case Instruction::LD_VX_I: return LD_VX_I(opcode, chip8);
+        // Without the XO-CHIP quirk these are the lax 5xyN encoding of 5xy0, as they always were
+        case Instruction::SAVE_VX_VY: return chip8->quirks.registerRanges ? SAVE_VX_VY(opcode, chip8) : SE_VX_VY(opcode, chip8);
+        case Instruction::LOAD_VX_VY: return chip8->quirks.registerRanges ? LOAD_VX_VY(opcode, chip8) : SE_VX_VY(opcode, chip8);
+
+        default:
+            chip8->Raise(Chip8::Trap::InvalidOpcode, chip8->pc - 2);
+            break;
+    }
+}
+
+// Superinstructions used by Chip8::Run. Each is entered like a normal handler (pc already past the
+// first instruction) and executes at most `budget` instructions. The opcodes after the first are
+// re-fetched from memory and checked, so a stale decode only ever shortens the fusion. Returns the
+// number of instructions executed; pc and opcode end up exactly as after that many Ticks.
+
+// Past the end of memory nothing fuses, the next dispatch traps on the fetch instead
+template <typename Machine>
+constexpr uint16_t FetchNext(Machine* chip8) {
+    if (chip8->pc > 0xFFE) [[unlikely]] return 0;
+    return chip8->memory[chip8->pc & 0xFFF] << 8 | chip8->memory[(chip8->pc + 1) & 0xFFF];
+}
+
+// 3xkk/4xkk + 1nnn - Jump to nnn unless the skip is taken.
+template <typename Machine>
+constexpr int SKIP_JMP(Opcode in, Machine* chip8, int budget) {
+    bool equal = chip8->registers[in.x()] == in.byte();
+    if (equal == (in.high() == 0x03)) {
+        chip8->pc += 2;
+        return 1;
+    }
+
+    uint16_t next = FetchNext(chip8);
+    if (budget < 2 || (next & 0xF000) != 0x1000) return 1;
+
+    chip8->opcode = next;
+    JMP(next, chip8);
+    return 2;
+}
+
+// 6xkk, 6xkk, ... - Load a run of registers with constants.
+template <typename Machine>
+constexpr int LD_VX_KK_CHAIN(Opcode in, Machine* chip8, int budget) {
+    LD_VX_KK(in, chip8);
+
+    int executed = 1;
+    while (executed < budget) {
+        uint16_t next = FetchNext(chip8);
+        if ((next & 0xF000) != 0x6000) break;
+
+        chip8->pc += 2;
+        chip8->opcode = next;
+        LD_VX_KK(next, chip8);
+        executed++;
+    }
+    return executed;
+}
+
+// Annn + Dxyn - Point I at a sprite and draw it.
+template <typename Machine>
+constexpr int LD_I_DRW(Opcode in, Machine* chip8, int budget) {
+    LD_I(in, chip8);
+
+    uint16_t next = FetchNext(chip8);
+    if (budget < 2 || (next & 0xF000) != 0xD000) return 1;
+
+    chip8->pc += 2;
+    chip8->opcode = next;
+    DRW(next, chip8);
+    return 2;
+}
+
+// 7xkk + 3xkk/4xkk - Step a loop counter and test it.
+template <typename Machine>
+constexpr int ADD_SKIP(Opcode in, Machine* chip8, int budget) {
+    ADD_VX_KK(in, chip8);
+
+    uint16_t next = FetchNext(chip8);
+    uint16_t kind = next & 0xF000;
+    if (budget < 2 || (kind != 0x3000 && kind != 0x4000)) return 1;
+
+    chip8->pc += 2;
+    chip8->opcode = next;
+    if (kind == 0x3000) {
+        SE_VX_KK(next, chip8);
+    } else {
+        SNE_VX_KK(next, chip8);
+    }
+    return 2;
 }
\ No newline at end of file
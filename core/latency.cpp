@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <numeric>
+#include <ostream>
+#include <string>
+#include "latency.h"
+
+Histogram::Histogram(double bucketWidth, int buckets) : width(bucketWidth), buckets(std::max(1, buckets) + 1, 0) {
+}
+
+void Histogram::Add(double value) {
+    size_t bucket = std::min(static_cast<size_t>(std::max(0.0, value) / width), buckets.size() - 1);
+    buckets[bucket]++;
+    samples.push_back(value);
+}
+
+void Histogram::Clear() {
+    std::fill(buckets.begin(), buckets.end(), 0);
+    samples.clear();
+}
+
+double Histogram::Min() const {
+    return samples.empty() ? 0.0 : *std::min_element(samples.begin(), samples.end());
+}
+
+double Histogram::Max() const {
+    return samples.empty() ? 0.0 : *std::max_element(samples.begin(), samples.end());
+}
+
+double Histogram::Mean() const {
+    return samples.empty() ? 0.0 : std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+}
+
+double Histogram::Percentile(double p) const {
+    if (samples.empty()) return 0.0;
+    std::vector<double> sorted = samples;
+    size_t rank = static_cast<size_t>(std::ceil(std::clamp(p, 0.0, 100.0) / 100.0 * sorted.size()));
+    auto nth = sorted.begin() + (rank > 0 ? rank - 1 : 0);
+    std::nth_element(sorted.begin(), nth, sorted.end());
+    return *nth;
+}
+
+void Histogram::Print(std::ostream& out, std::string_view unit) const {
+    out << std::fixed << std::setprecision(2)
+        << Count() << " samples, min " << Min() << ", mean " << Mean() << ", p50 " << Percentile(50) << ", p95 " << Percentile(95)
+        << ", p99 " << Percentile(99) << ", max " << Max() << ' ' << unit << '\n';
+
+    uint64_t peak = Count() ? *std::max_element(buckets.begin(), buckets.end()) : 0;
+    for (size_t bucket = 0; bucket < buckets.size(); ++bucket) {
+        if (buckets[bucket] == 0) continue;
+        std::string bar(static_cast<size_t>(buckets[bucket] * 50 / peak), '#');
+        if (bucket + 1 < buckets.size()) {
+            out << std::setw(8) << bucket * width << "-" << std::left << std::setw(8) << (bucket + 1) * width << std::right;
+        } else {
+            out << std::setw(8) << bucket * width << "+" << std::setw(8) << ' ';
+        }
+        out << std::setw(8) << buckets[bucket] << ' ' << bar << '\n';
+    }
+    out.unsetf(std::ios::floatfield);
+}
+
+LatencyProbe::LatencyProbe(double bucketWidth, int buckets) : toDisplay(bucketWidth, buckets), toPresent(bucketWidth, buckets) {
+}
+
+void LatencyProbe::Input(const std::array<uint8_t, 16>& keypad, double now) {
+    if (open && now - edge > toDisplay.BucketWidth() * (toDisplay.Buckets().size() - 1)) {
+        open = false;
+        unanswered++;
+    }
+    if (keypad != keys && !open) {
+        open = true;
+        edge = now;
+    }
+    keys = keypad;
+}
+
+bool LatencyProbe::Display(const Chip8::Display& display, double now) {
+    if (!open) {
+        before = display;
+        return false;
+    }
+    if (std::memcmp(display.data(), before.data(), display.size()) == 0) return false;
+
+    before = display;
+    toDisplay.Add(now - edge);
+    open = false;
+    presentPending = true;
+    return true;
+}
+
+void LatencyProbe::Present(double now) {
+    if (!presentPending) return;
+    toPresent.Add(now - edge);
+    presentPending = false;
+}
+
+void LatencyProbe::Clear() {
+    toDisplay.Clear();
+    toPresent.Clear();
+    unanswered = 0;
+    open = false;
+    presentPending = false;
+}
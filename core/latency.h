@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <string_view>
+#include <vector>
+#include "chip8.h"
+
+// Fixed-width buckets from 0 plus one overflow bucket. Samples are kept as well (latency
+// measurements come at human input rates), so percentiles are exact.
+class Histogram {
+public:
+    Histogram(double bucketWidth, int buckets);
+
+    void Add(double value);
+    void Clear();
+
+    [[nodiscard]] uint64_t Count() const { return samples.size(); }
+    [[nodiscard]] double Min() const;
+    [[nodiscard]] double Max() const;
+    [[nodiscard]] double Mean() const;
+    // Nearest-rank percentile, p in 0-100
+    [[nodiscard]] double Percentile(double p) const;
+    [[nodiscard]] double BucketWidth() const { return width; }
+    // The last entry counts values past the last bucket
+    [[nodiscard]] const std::vector<uint64_t>& Buckets() const { return buckets; }
+
+    // Summary line plus one bar per non-empty bucket
+    void Print(std::ostream& out, std::string_view unit) const;
+
+private:
+    double width;
+    std::vector<uint64_t> buckets;
+    std::vector<double> samples;
+};
+
+// Measures input-to-display latency: a change of the held keys opens a measurement and the first
+// change of the display after it closes it. Times are in whatever unit the host counts in
+// (emulated frames headless, milliseconds in the GUI). One measurement is open at a time; edges
+// while one is open are part of the same interaction and ignored. Edges the display never
+// answers within the histogram's range are counted as unanswered.
+class LatencyProbe {
+public:
+    LatencyProbe(double bucketWidth, int buckets);
+
+    // Before running: the keypad the program is about to see
+    void Input(const std::array<uint8_t, 16>& keypad, double now);
+    // After running: true when this display closed a measurement
+    bool Display(const Chip8::Display& display, double now);
+    // Optional third stage for hosts that present frames: the first present after Display() closed a measurement
+    void Present(double now);
+    void Clear();
+
+    [[nodiscard]] const Histogram& ToDisplay() const { return toDisplay; }
+    [[nodiscard]] const Histogram& ToPresent() const { return toPresent; }
+    [[nodiscard]] uint64_t Unanswered() const { return unanswered; }
+
+private:
+    Histogram toDisplay;
+    Histogram toPresent;
+    uint64_t unanswered = 0;
+    std::array<uint8_t, 16> keys = { 0 };
+    Chip8::Display before = { 0 };
+    bool open = false;
+    bool presentPending = false;
+    double edge = 0.0;
+};
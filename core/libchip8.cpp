@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "chip8.h"
+#include "hash.h"
+#include "libchip8.h"
+
+struct chip8_instance {
+    Chip8 chip8;
+    std::shared_ptr<const RomImage> rom;
+    uint32_t cyclesPerFrame = 16;
+};
+
+namespace {
+
+// Header in front of the raw Chip8::State so blobs from other builds are rejected, not misread
+struct StateHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    uint32_t reserved;
+};
+
+constexpr uint32_t kStateMagic = 0x54533843; // "C8ST"
+constexpr uint32_t kStateVersion = 4;
+
+static_assert(std::is_trivially_copyable_v<Chip8::State>, "save states are copied as raw bytes");
+static_assert(static_cast<int>(Chip8::Trap::StackOverflow) == CHIP8_TRAP_STACK_OVERFLOW &&
+              static_cast<int>(Chip8::Trap::StackUnderflow) == CHIP8_TRAP_STACK_UNDERFLOW &&
+              static_cast<int>(Chip8::Trap::InvalidOpcode) == CHIP8_TRAP_INVALID_OPCODE &&
+              static_cast<int>(Chip8::Trap::OutOfRange) == CHIP8_TRAP_OUT_OF_RANGE, "trap codes are returned as is");
+
+// Instances that load identical ROM bytes get the same image, so its pages are shared between them
+std::shared_ptr<const RomImage> ShareImage(std::span<const uint8_t> rom) {
+    static std::mutex mutex;
+    static std::unordered_map<uint64_t, std::vector<std::weak_ptr<const RomImage>>> images;
+
+    std::lock_guard lock(mutex);
+    auto& candidates = images[Fnv1a(rom)];
+    std::erase_if(candidates, [](const auto& image) { return image.expired(); });
+    for (const auto& weak : candidates) {
+        auto image = weak.lock();
+        if (!image || image->size != rom.size()) continue;
+
+        bool same = true;
+        for (size_t i = 0; i < rom.size() && same; ++i) {
+            same = (*image)[Chip8::kStartAddress + i] == rom[i];
+        }
+        if (same) return image;
+    }
+
+    auto image = Chip8::CreateImage(rom);
+    candidates.push_back(image);
+    return image;
+}
+
+} // namespace
+
+uint32_t chip8_api_version(void) {
+    return CHIP8_API_VERSION;
+}
+
+chip8_instance* chip8_create(void) {
+    return new (std::nothrow) chip8_instance();
+}
+
+void chip8_destroy(chip8_instance* chip8) {
+    delete chip8;
+}
+
+int chip8_load_rom(chip8_instance* chip8, const uint8_t* data, size_t size) {
+    if (!chip8 || !data) return CHIP8_E_INVALID_ARGUMENT;
+    if (size == 0 || size > Chip8::kMaxRomSize) return CHIP8_E_ROM_SIZE;
+
+    chip8->rom = ShareImage({ data, size });
+    chip8_reset(chip8);
+    return 0;
+}
+
+void chip8_reset(chip8_instance* chip8) {
+    if (!chip8) return;
+
+    chip8->chip8.ResetChip8();
+    if (chip8->rom) {
+        chip8->chip8.LoadRom(chip8->rom);
+    }
+}
+
+void chip8_seed(chip8_instance* chip8, uint64_t seed, uint64_t stream) {
+    if (!chip8) return;
+
+    chip8->chip8.rand.seed(seed, stream);
+}
+
+void chip8_set_cycles_per_frame(chip8_instance* chip8, uint32_t cycles) {
+    if (chip8) chip8->cyclesPerFrame = cycles;
+}
+
+void chip8_step_cycles(chip8_instance* chip8, uint32_t cycles) {
+    if (!chip8) return;
+
+    // Run() counts in int, so counts past INT_MAX go in slices; one that ends early (a trap or
+    // an Fx0A wait) ends the call
+    while (cycles > 0) {
+        int slice = static_cast<int>(std::min<uint32_t>(cycles, INT_MAX));
+        if (chip8->chip8.Run(slice) < slice) break;
+        cycles -= slice;
+    }
+}
+
+void chip8_step_frames(chip8_instance* chip8, uint32_t frames) {
+    if (!chip8) return;
+
+    for (uint32_t i = 0; i < frames; ++i) {
+        chip8->chip8.RunFrame(chip8->cyclesPerFrame);
+
+        // The keypad can't change during this call, so an instance parked on Fx0A stays parked,
+        // and a trapped one stays trapped regardless
+        if (chip8->chip8.Waiting() || chip8->chip8.Trapped()) {
+            for (++i; i < frames; ++i) {
+                chip8->chip8.TickTimer();
+            }
+        }
+    }
+}
+
+int chip8_waiting(const chip8_instance* chip8) {
+    return chip8 && chip8->chip8.Waiting();
+}
+
+int chip8_trap(const chip8_instance* chip8, uint16_t* pc, uint16_t* opcode) {
+    if (!chip8 || !chip8->chip8.Trapped()) return CHIP8_TRAP_NONE;
+
+    if (pc) *pc = chip8->chip8.pc;
+    if (opcode) *opcode = chip8->chip8.opcode;
+    return static_cast<int>(chip8->chip8.trap);
+}
+
+void chip8_step_many(chip8_instance* const* handles, size_t count, uint32_t frames) {
+    if (!handles) return;
+
+    for (size_t i = 0; i < count; ++i) {
+        chip8_step_frames(handles[i], frames);
+    }
+}
+
+void chip8_set_keypad(chip8_instance* chip8, uint16_t mask) {
+    if (!chip8) return;
+
+    for (int key = 0; key < 16; ++key) {
+        chip8->chip8.keypad[key] = (mask >> key) & 1;
+    }
+}
+
+const uint8_t* chip8_framebuffer(const chip8_instance* chip8) {
+    return chip8 ? chip8->chip8.display.data() : nullptr;
+}
+
+size_t chip8_state_size(void) {
+    return sizeof(StateHeader) + sizeof(Chip8::State);
+}
+
+int chip8_save_state(const chip8_instance* chip8, void* buffer, size_t size) {
+    if (!chip8 || !buffer) return CHIP8_E_INVALID_ARGUMENT;
+    if (size < chip8_state_size()) return CHIP8_E_BUFFER_SIZE;
+
+    StateHeader header = { kStateMagic, kStateVersion, sizeof(Chip8::State), 0 };
+    Chip8::State state;
+    chip8->chip8.SaveState(state);
+
+    auto* out = static_cast<uint8_t*>(buffer);
+    std::memcpy(out, &header, sizeof(header));
+    std::memcpy(out + sizeof(header), &state, sizeof(state));
+    return 0;
+}
+
+int chip8_load_state(chip8_instance* chip8, const void* buffer, size_t size) {
+    if (!chip8 || !buffer) return CHIP8_E_INVALID_ARGUMENT;
+    if (size < chip8_state_size()) return CHIP8_E_BUFFER_SIZE;
+
+    StateHeader header;
+    auto* in = static_cast<const uint8_t*>(buffer);
+    std::memcpy(&header, in, sizeof(header));
+    if (header.magic != kStateMagic || header.version != kStateVersion || header.size != sizeof(Chip8::State)) {
+        return CHIP8_E_STATE_VERSION;
+    }
+
+    Chip8::State state;
+    std::memcpy(&state, in + sizeof(header), sizeof(state));
+    return chip8->chip8.LoadState(state) ? 0 : CHIP8_E_INVALID_STATE;
+}
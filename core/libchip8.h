@@ -0,0 +1,107 @@
+#pragma once
+
+/*
+    libchip8 - flat C interface to the emulator core for embedding in other runtimes.
+
+    All functions are safe to call from C and FFI layers (no exceptions cross the boundary).
+    Instances are independent and may be driven from different threads, but a single
+    instance must not be used concurrently.
+
+    Functions returning int return 0 on success and a negative CHIP8_E_* value on failure.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+    #if defined(CHIP8_BUILD_SHARED)
+        #define CHIP8_API __declspec(dllexport)
+    #elif defined(CHIP8_USE_SHARED)
+        #define CHIP8_API __declspec(dllimport)
+    #else
+        #define CHIP8_API
+    #endif
+#else
+    #define CHIP8_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHIP8_API_VERSION 5
+
+#define CHIP8_DISPLAY_WIDTH 64
+#define CHIP8_DISPLAY_HEIGHT 32
+
+#define CHIP8_E_INVALID_ARGUMENT -1
+#define CHIP8_E_ROM_SIZE -2
+#define CHIP8_E_BUFFER_SIZE -3
+#define CHIP8_E_STATE_VERSION -4
+#define CHIP8_E_INVALID_STATE -5
+
+typedef struct chip8_instance chip8_instance;
+
+// Version of this header the library was built from, compare against CHIP8_API_VERSION
+CHIP8_API uint32_t chip8_api_version(void);
+
+// Returns NULL on allocation failure
+CHIP8_API chip8_instance* chip8_create(void);
+CHIP8_API void chip8_destroy(chip8_instance* chip8);
+
+// Copies the ROM image, reset() restarts from it
+CHIP8_API int chip8_load_rom(chip8_instance* chip8, const uint8_t* data, size_t size);
+CHIP8_API void chip8_reset(chip8_instance* chip8);
+
+// Seeds the CXNN random generator; reset() rewinds to the start of this seed and stream.
+// Sequences are identical on every platform, and different streams of the same seed give
+// different sequences (which are not guaranteed never to overlap).
+CHIP8_API void chip8_seed(chip8_instance* chip8, uint64_t seed, uint64_t stream);
+
+// Instructions per 60 Hz frame used by step_frames/step_many (default 16, i.e. 960 Hz)
+CHIP8_API void chip8_set_cycles_per_frame(chip8_instance* chip8, uint32_t cycles);
+
+// Executes up to cycles instructions without touching the 60 Hz timers. Every uint32_t count is
+// honoured (counts past INT_MAX run in slices); it stops early on a trap or an Fx0A wait.
+CHIP8_API void chip8_step_cycles(chip8_instance* chip8, uint32_t cycles);
+
+// Executes whole frames: cycles_per_frame instructions followed by a timer tick
+CHIP8_API void chip8_step_frames(chip8_instance* chip8, uint32_t frames);
+
+// Steps every instance in handles by the same number of frames in a single call. NULL entries are skipped.
+CHIP8_API void chip8_step_many(chip8_instance* const* handles, size_t count, uint32_t frames);
+
+// 1 while the program waits in Fx0A for a key press and release. Stepping a waiting instance
+// only counts down its timers until the keypad changes.
+CHIP8_API int chip8_waiting(const chip8_instance* chip8);
+
+// Traps returned by chip8_trap(). A trapped instance stops executing (its timers still count
+// down) until reset() or load_rom(); other instances are unaffected.
+#define CHIP8_TRAP_NONE 0
+#define CHIP8_TRAP_STACK_OVERFLOW 1
+#define CHIP8_TRAP_STACK_UNDERFLOW 2
+#define CHIP8_TRAP_INVALID_OPCODE 3
+#define CHIP8_TRAP_OUT_OF_RANGE 4
+
+// Returns the trap the instance halted on, and where: pc is the faulting instruction's address
+// and opcode the instruction; for a fetch past 0xFFF, pc is that address and opcode the instruction
+// that got there. Either pointer may be NULL.
+CHIP8_API int chip8_trap(const chip8_instance* chip8, uint16_t* pc, uint16_t* opcode);
+
+// Bit n set = key n held
+CHIP8_API void chip8_set_keypad(chip8_instance* chip8, uint16_t mask);
+
+// CHIP8_DISPLAY_WIDTH * CHIP8_DISPLAY_HEIGHT bytes, one per pixel (0 or 1), row-major.
+// The pointer stays valid for the lifetime of the instance.
+CHIP8_API const uint8_t* chip8_framebuffer(const chip8_instance* chip8);
+
+// Save states are opaque, versioned blobs of chip8_state_size() bytes. load_state rejects a blob
+// from another build with CHIP8_E_STATE_VERSION and a damaged one with CHIP8_E_INVALID_STATE,
+// leaving the instance as it was.
+CHIP8_API size_t chip8_state_size(void);
+CHIP8_API int chip8_save_state(const chip8_instance* chip8, void* buffer, size_t size);
+CHIP8_API int chip8_load_state(chip8_instance* chip8, const void* buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
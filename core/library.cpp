@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include "hash.h"
+#include "library.h"
+
+RomLibrary::RomLibrary(int frames, int cycles, unsigned threads) : frames(frames), cycles(cycles),
+    threads(threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency())) {
+}
+
+RomLibrary::~RomLibrary() {
+    Cancel();
+}
+
+void RomLibrary::Cancel() {
+    cancelled = true;
+    if (scanner.joinable()) {
+        scanner.join();
+    }
+    cancelled = false;
+}
+
+void RomLibrary::Scan(const std::filesystem::path& directory) {
+    Cancel();
+    {
+        std::lock_guard lock(mutex);
+        entries.clear();
+    }
+    version.fetch_add(1, std::memory_order_release);
+    scanning = true;
+    scanner = std::thread(&RomLibrary::Run, this, directory);
+}
+
+std::vector<RomLibrary::Entry> RomLibrary::Entries() const {
+    std::lock_guard lock(mutex);
+    return entries;
+}
+
+void RomLibrary::Run(std::filesystem::path directory) {
+    // List and read everything first; ROMs are at most 3.5 KB each
+    std::vector<std::filesystem::path> paths;
+    std::error_code error;
+    for (const auto& file : std::filesystem::directory_iterator(directory, error)) {
+        if (file.is_regular_file(error) && file.file_size(error) > 0 && file.file_size(error) <= Chip8::kMaxRomSize) {
+            paths.push_back(file.path());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    std::vector<std::vector<uint8_t>> roms;
+    std::vector<size_t> pending;
+    {
+        std::lock_guard lock(mutex);
+        for (const auto& path : paths) {
+            std::ifstream file(path, std::ios::binary);
+            std::vector<uint8_t> rom((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            if (rom.empty()) continue;
+
+            Entry entry;
+            entry.path = path;
+            entry.title = path.filename().string();
+            entry.size = rom.size();
+            entry.hash = Fnv1a(rom);
+            if (auto cached = cache.find(entry.hash); cached != cache.end()) {
+                entry.thumbnail = cached->second;
+                entry.ready = true;
+            } else {
+                pending.push_back(entries.size());
+            }
+            entries.push_back(std::move(entry));
+            roms.push_back(std::move(rom));
+        }
+    }
+    version.fetch_add(1, std::memory_order_release);
+
+    std::atomic<size_t> next = 0;
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < std::min<size_t>(threads, pending.size()); ++i) {
+        workers.emplace_back([&] {
+            for (size_t job; !cancelled && (job = next.fetch_add(1)) < pending.size();) {
+                Render(pending[job], roms[pending[job]]);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    scanning = false;
+}
+
+void RomLibrary::Render(size_t entry, const std::vector<uint8_t>& rom) {
+    // Loaded through an image so nothing is logged per ROM; no keys are pressed
+    Chip8 chip8;
+    chip8.LoadRom(Chip8::CreateImage(rom));
+    for (int frame = 0; frame < frames && !cancelled; ++frame) {
+        chip8.RunFrame(cycles);
+    }
+    if (cancelled) return;
+
+    std::lock_guard lock(mutex);
+    cache[entries[entry].hash] = chip8.display;
+    entries[entry].thumbnail = chip8.display;
+    entries[entry].ready = true;
+    version.fetch_add(1, std::memory_order_release);
+}
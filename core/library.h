@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "chip8.h"
+
+// Background scanner behind the GUI's ROM browser. Scan() lists the ROMs in a directory on a
+// worker thread, then a pool of threads runs each one headlessly for a few hundred frames and
+// keeps the final display as its thumbnail. Thumbnails are cached by the FNV-1a hash of the ROM
+// bytes for the lifetime of the library, so rescanning (or a renamed copy) costs a file read.
+class RomLibrary {
+public:
+    struct Entry {
+        std::filesystem::path path;
+        std::string title;
+        size_t size = 0;
+        uint64_t hash = 0;
+        bool ready = false;                 // Thumbnail rendered
+        Chip8::Display thumbnail = { 0 };
+    };
+
+    explicit RomLibrary(int frames = 300, int cycles = 16, unsigned threads = 0);
+    ~RomLibrary();
+    RomLibrary(const RomLibrary&) = delete;
+    RomLibrary& operator=(const RomLibrary&) = delete;
+
+    // Replaces the listing with the ROMs in directory, cancelling a scan still in progress
+    void Scan(const std::filesystem::path& directory);
+    void Cancel();
+
+    // Bumped whenever an entry is added or gets its thumbnail, so callers copy only on change
+    [[nodiscard]] uint64_t Version() const { return version.load(std::memory_order_acquire); }
+    [[nodiscard]] std::vector<Entry> Entries() const;
+    [[nodiscard]] bool Scanning() const { return scanning.load(std::memory_order_acquire); }
+
+private:
+    void Run(std::filesystem::path directory);
+    void Render(size_t entry, const std::vector<uint8_t>& rom);
+
+    int frames;
+    int cycles;
+    unsigned threads;
+
+    mutable std::mutex mutex;
+    std::vector<Entry> entries;
+    std::unordered_map<uint64_t, Chip8::Display> cache;
+    std::atomic<uint64_t> version = 0;
+    std::atomic<bool> scanning = false;
+    std::atomic<bool> cancelled = false;
+    std::thread scanner;
+};
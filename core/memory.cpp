@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <cstring>
+#include "memory.h"
+
+std::shared_ptr<const RomImage> RomImage::Create(const std::array<uint8_t, 4096>& boot, size_t romSize, std::string title, std::string path) {
+    auto image = std::make_shared<RomImage>();
+    for (int page = 0; page < kPages; ++page) {
+        std::copy_n(boot.begin() + page * MemoryPage::kSize, MemoryPage::kSize, image->pages[page].bytes.begin());
+    }
+
+    // Fusion looks ahead across page boundaries, so decode once all pages are filled in
+    for (int page = 0; page < kPages; ++page) {
+        for (int op = 0; op < MemoryPage::kSize / 2; ++op) {
+            image->pages[page].ops[op] = Decode(boot, static_cast<uint16_t>(page * MemoryPage::kSize + op * 2));
+        }
+    }
+
+    image->size = romSize;
+    image->title = std::move(title);
+    image->path = std::move(path);
+    return image;
+}
+
+Memory::Memory() {
+    static const auto empty = RomImage::Create({}, 0);
+    Attach(empty);
+}
+
+Memory::Memory(const Memory& other) : pages(other.pages), image(other.image), generation(other.generation), pageGenerations(other.pageGenerations), dirty(other.dirty), breaks(other.breaks), breaksGeneration(other.breaksGeneration), tagged(other.tagged) {
+    for (int page = 0; page < kPages; ++page) {
+        if (other.owned[page]) {
+            owned[page] = std::make_unique<MemoryPage>(*other.owned[page]);
+            pages[page] = owned[page].get();
+        }
+    }
+}
+
+// Reuses the private pages this side already owns, so copying into the same scratch machine
+// every frame (run-ahead) doesn't allocate once it has warmed up
+Memory& Memory::operator=(const Memory& other) {
+    if (this == &other) return *this;
+
+    image = other.image;
+    for (int page = 0; page < kPages; ++page) {
+        if (other.owned[page]) {
+            if (owned[page]) {
+                *owned[page] = *other.owned[page];
+            } else {
+                owned[page] = std::make_unique<MemoryPage>(*other.owned[page]);
+            }
+            pages[page] = owned[page].get();
+        } else {
+            owned[page].reset();
+            pages[page] = other.pages[page];
+        }
+    }
+    generation = other.generation;
+    pageGenerations = other.pageGenerations;
+    dirty = other.dirty;
+    breaks = other.breaks;
+    breaksGeneration = other.breaksGeneration;
+    tagged = other.tagged;
+    return *this;
+}
+
+void Memory::Attach(std::shared_ptr<const RomImage> shared) {
+    image = std::move(shared);
+    for (int page = 0; page < kPages; ++page) {
+        owned[page].reset();
+        pages[page] = &image->pages[page];
+        MarkDirty(page);
+    }
+    if (tagged) Retag();
+}
+
+void Memory::CopyTo(std::array<uint8_t, 4096>& out) const {
+    for (int page = 0; page < kPages; ++page) {
+        std::copy(pages[page]->bytes.begin(), pages[page]->bytes.end(), out.begin() + page * MemoryPage::kSize);
+    }
+}
+
+void Memory::Assign(const std::array<uint8_t, 4096>& in) {
+    for (int page = 0; page < kPages; ++page) {
+        const uint8_t* bytes = in.data() + page * MemoryPage::kSize;
+        if (std::memcmp(bytes, pages[page]->bytes.data(), MemoryPage::kSize) != 0) {
+            MarkDirty(page);
+        }
+
+        if (std::memcmp(bytes, image->pages[page].bytes.data(), MemoryPage::kSize) == 0) {
+            owned[page].reset();
+            pages[page] = &image->pages[page];
+            continue;
+        }
+
+        MemoryPage& target = Own(page);
+        for (int i = 0; i < MemoryPage::kSize; ++i) {
+            if (target.bytes[i] != bytes[i]) {
+                target.bytes[i] = bytes[i];
+                target.ops[i >> 1].valid = false;
+            }
+        }
+    }
+    if (tagged) Retag();
+}
+
+void Memory::SetBreakpoints(const std::bitset<4096>* breakpoints, uint64_t generation) {
+    if (breakpoints == breaks && generation == breaksGeneration) return;
+
+    breaks = breakpoints;
+    breaksGeneration = generation;
+    tagged = breaks && breaks->any();
+    Retag();
+}
+
+void Memory::Retag() {
+    // An op near the end of a page can fuse into the start of the next one
+    constexpr int kReach = MemoryPage::kSize + (kMaxFusedChain - 1) * 2;
+
+    for (int page = 0; page < kPages; ++page) {
+        bool hit = false;
+        for (int i = 0; i < kReach && tagged && !hit; ++i) {
+            hit = breaks->test((page * MemoryPage::kSize + i) & 0xFFF);
+        }
+
+        if (hit) {
+            MemoryPage& target = Own(page);
+            for (int op = 0; op < MemoryPage::kSize / 2; ++op) {
+                auto address = static_cast<uint16_t>(page * MemoryPage::kSize + op * 2);
+                target.ops[op] = Decode(*this, address);
+                Tag(target.ops[op], address);
+            }
+        } else if (owned[page]) {
+            // Untagged ops are decoded again on their next use
+            for (auto& op : owned[page]->ops) {
+                if (op.fused == Superinstruction::BREAK) op.valid = false;
+            }
+        }
+    }
+}
+
+uint16_t Memory::ChangedSince(uint64_t seen) const {
+    uint16_t changed = 0;
+    for (int page = 0; page < kPages; ++page) {
+        if (pageGenerations[page] > seen) changed |= uint16_t(1u << page);
+    }
+    return changed;
+}
+
+int Memory::PrivatePages() const {
+    return static_cast<int>(std::count_if(owned.begin(), owned.end(), [](const auto& page) { return page != nullptr; }));
+}
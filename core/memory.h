@@ -0,0 +1,146 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include "fusion.h"
+
+// 256 bytes of address space plus the decoded op for each of its even addresses
+struct MemoryPage {
+    static constexpr int kSize = 256;
+
+    std::array<uint8_t, kSize> bytes = { 0 };
+    std::array<DecodedOp, kSize / 2> ops = {};
+};
+
+// Immutable boot memory (font + program) and metadata of a loaded ROM. Every instance loaded from
+// the same image reads its pages directly until it writes to one of them.
+class RomImage {
+public:
+    static constexpr int kPages = 16;
+
+    // Splits a full 4 KB boot image into pages and pre-decodes every instruction in it
+    static std::shared_ptr<const RomImage> Create(const std::array<uint8_t, 4096>& boot, size_t romSize,
+        std::string title = "N/A", std::string path = "N/A");
+
+    [[nodiscard]] uint8_t operator[](size_t address) const {
+        return pages[(address >> 8) & 0x0F].bytes[address & 0xFF];
+    }
+
+    std::array<MemoryPage, kPages> pages;
+    size_t size = 0;
+    std::string title;
+    std::string path;
+};
+
+// The 4 KB address space of one instance as 16 pages. Pages are shared read-only with the
+// attached RomImage and copied into the instance on the first write (copy-on-write), so many
+// instances of one ROM only pay for the pages their program actually stores to.
+//
+// Write() is the only way bytes change after Attach()/Assign(). Addresses wrap at 4 KB there and
+// in operator[], so I + n never leaves the address space. Every change is tracked per page:
+// Generation() counts changes, ChangedSince() lets any number of consumers (decode caches,
+// snapshot deltas, debug views) each keep their own last-seen generation, and the dirty bitmap
+// serves a single owner that clears it as it reads.
+class Memory {
+public:
+    static constexpr int kPages = RomImage::kPages;
+
+    Memory();
+    Memory(const Memory& other);
+    Memory& operator=(const Memory& other);
+    Memory(Memory&&) noexcept = default;
+    Memory& operator=(Memory&&) noexcept = default;
+
+    // Replaces the whole address space with the image, dropping private pages
+    void Attach(std::shared_ptr<const RomImage> image);
+    [[nodiscard]] const std::shared_ptr<const RomImage>& Image() const { return image; }
+
+    [[nodiscard]] uint8_t operator[](size_t address) const {
+        return pages[(address >> 8) & 0x0F]->bytes[address & 0xFF];
+    }
+
+    void Write(size_t address, uint8_t value) {
+        // Storing the value already there changes nothing, and keeps a shared page shared
+        int index = (address >> 8) & 0x0F;
+        if (pages[index]->bytes[address & 0xFF] == value) return;
+
+        MemoryPage& page = Own(index);
+        page.bytes[address & 0xFF] = value;
+        page.ops[(address & 0xFF) >> 1].valid = false;
+        MarkDirty(index);
+    }
+
+    [[nodiscard]] uint64_t Generation() const { return generation; }
+    // Bit n set = page n (addresses n * 256 onwards) changed after generation `seen`
+    [[nodiscard]] uint16_t ChangedSince(uint64_t seen) const;
+    [[nodiscard]] uint16_t DirtyPages() const { return dirty; }
+    uint16_t TakeDirtyPages() { return std::exchange(dirty, uint16_t(0)); }
+
+    // Decoded op at an even address. Shared pages are decoded up front, private ones lazily after a write.
+    [[nodiscard]] const DecodedOp& Decoded(uint16_t address) {
+        int page = (address >> 8) & 0x0F;
+        if (!owned[page]) return pages[page]->ops[(address & 0xFF) >> 1];
+
+        DecodedOp& op = owned[page]->ops[(address & 0xFF) >> 1];
+        if (!op.valid) [[unlikely]] {
+            op = Decode(*this, address);
+            if (tagged) Tag(op, address);
+        }
+        return op;
+    }
+
+    // Marks the decoded ops that would execute a breakpoint address as BREAK, so the fused engine
+    // keeps running around them. Pages holding a tag become private; the rest stay shared. The set
+    // is referenced, not copied, and must outlive the tags (nullptr drops them). Returns at once
+    // while the pointer and generation match the last call.
+    void SetBreakpoints(const std::bitset<4096>* breakpoints, uint64_t generation);
+    [[nodiscard]] bool Tagged() const { return tagged; }
+
+    void CopyTo(std::array<uint8_t, 4096>& out) const;
+
+    // Loads a full address space; pages identical to the image's stay shared
+    void Assign(const std::array<uint8_t, 4096>& in);
+
+    [[nodiscard]] int PrivatePages() const;
+    [[nodiscard]] static constexpr size_t size() { return 4096; }
+
+private:
+    MemoryPage& Own(int page) {
+        if (!owned[page]) [[unlikely]] {
+            owned[page] = std::make_unique<MemoryPage>(*pages[page]);
+            pages[page] = owned[page].get();
+        }
+        return *owned[page];
+    }
+
+    void Tag(DecodedOp& op, uint16_t address) const {
+        for (int i = 0; i < op.length; ++i) {
+            if (breaks->test((address + i * 2) & 0xFFF)) {
+                op.fused = Superinstruction::BREAK;
+                op.length = 1;
+                return;
+            }
+        }
+    }
+
+    void Retag();
+
+    void MarkDirty(int page) {
+        dirty |= uint16_t(1u << page);
+        pageGenerations[page] = ++generation;
+    }
+
+    std::array<const MemoryPage*, kPages> pages;
+    std::array<std::unique_ptr<MemoryPage>, kPages> owned;
+    std::shared_ptr<const RomImage> image;
+    uint64_t generation = 0;
+    std::array<uint64_t, kPages> pageGenerations = { 0 };
+    uint16_t dirty = 0;
+    const std::bitset<4096>* breaks = nullptr;
+    uint64_t breaksGeneration = 0;
+    bool tagged = false;
+};
@@ -0,0 +1,227 @@
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include "metrics.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <cerrno>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+    #define CHIP8_METRICS_SOCKET
+    #if !defined(MSG_NOSIGNAL)
+        #define MSG_NOSIGNAL 0
+    #endif
+#endif
+
+namespace {
+
+constexpr auto kRelaxed = std::memory_order_relaxed;
+
+struct Family {
+    const char* name;
+    const char* type;
+    const char* help;
+};
+
+// Label values escape backslashes, quotes and newlines
+std::string Escape(std::string_view label) {
+    std::string escaped;
+    for (char c : label) {
+        if (c == '\\') escaped += "\\\\";
+        else if (c == '"') escaped += "\\\"";
+        else if (c == '\n') escaped += "\\n";
+        else escaped += c;
+    }
+    return escaped;
+}
+
+} // namespace
+
+InstanceMetrics& MetricsRegistry::Add(std::string label) {
+    std::lock_guard lock(mutex);
+    entries.push_back({ std::move(label), std::make_unique<InstanceMetrics>() });
+    return *entries.back().metrics;
+}
+
+void MetricsRegistry::UpdateRates(std::chrono::milliseconds window) {
+    std::lock_guard lock(mutex);
+    auto now = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed = now - lastUpdate;
+    if (elapsed < window) return;
+    lastUpdate = now;
+
+    for (auto& entry : entries) {
+        InstanceMetrics& m = *entry.metrics;
+        uint64_t instructions = m.instructions.load(kRelaxed);
+        uint64_t emulatedFrames = m.emulatedFrames.load(kRelaxed);
+        uint64_t wallFrames = m.wallFrames.load(kRelaxed);
+
+        m.mips.store((instructions - entry.lastInstructions) / elapsed.count() / 1e6, kRelaxed);
+        m.emulatedFps.store((emulatedFrames - entry.lastEmulatedFrames) / elapsed.count(), kRelaxed);
+        m.wallFps.store((wallFrames - entry.lastWallFrames) / elapsed.count(), kRelaxed);
+
+        entry.lastInstructions = instructions;
+        entry.lastEmulatedFrames = emulatedFrames;
+        entry.lastWallFrames = wallFrames;
+    }
+}
+
+std::string MetricsRegistry::Format() {
+    static constexpr Family kFamilies[] = {
+        { "chip8_instructions_total", "counter", "Instructions executed" },
+        { "chip8_draws_total", "counter", "DRW instructions executed" },
+        { "chip8_emulated_frames_total", "counter", "60 Hz timer ticks emulated" },
+        { "chip8_wall_frames_total", "counter", "Frames presented by the host" },
+        { "chip8_texture_uploads_total", "counter", "Display texture uploads" },
+        { "chip8_skipped_frames_total", "counter", "Frames that started more than a frame period late" },
+        { "chip8_scheduler_lag_microseconds", "gauge", "How late the last frame started" },
+        { "chip8_mips", "gauge", "Million instructions per second over the last window" },
+        { "chip8_emulated_fps", "gauge", "Emulated frames per second over the last window" },
+        { "chip8_wall_fps", "gauge", "Presented frames per second over the last window" },
+    };
+
+    std::lock_guard lock(mutex);
+    std::ostringstream out;
+    for (size_t family = 0; family < std::size(kFamilies); ++family) {
+        out << "# HELP " << kFamilies[family].name << ' ' << kFamilies[family].help << '\n'
+            << "# TYPE " << kFamilies[family].name << ' ' << kFamilies[family].type << '\n';
+        for (const auto& entry : entries) {
+            const InstanceMetrics& m = *entry.metrics;
+            out << kFamilies[family].name << "{instance=\"" << Escape(entry.label) << "\"} ";
+            switch (family) {
+            case 0: out << m.instructions.load(kRelaxed); break;
+            case 1: out << m.draws.load(kRelaxed); break;
+            case 2: out << m.emulatedFrames.load(kRelaxed); break;
+            case 3: out << m.wallFrames.load(kRelaxed); break;
+            case 4: out << m.textureUploads.load(kRelaxed); break;
+            case 5: out << m.skippedFrames.load(kRelaxed); break;
+            case 6: out << m.schedulerLagMicros.load(kRelaxed); break;
+            case 7: out << m.mips.load(kRelaxed); break;
+            case 8: out << m.emulatedFps.load(kRelaxed); break;
+            case 9: out << m.wallFps.load(kRelaxed); break;
+            }
+            out << '\n';
+        }
+    }
+    return out.str();
+}
+
+MetricsExporter::~MetricsExporter() {
+    Stop();
+}
+
+bool MetricsExporter::Start(std::string_view filePath, std::string_view socketPath, std::chrono::milliseconds interval) {
+    Stop();
+    this->filePath = filePath;
+    this->socketPath = socketPath;
+    this->interval = interval;
+
+    if (!this->socketPath.empty()) {
+#if defined(CHIP8_METRICS_SOCKET)
+        listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (listener < 0 || this->socketPath.size() >= sizeof(addr.sun_path)) {
+            std::cerr << "Unable to open metrics socket: " << this->socketPath << std::endl;
+            if (listener >= 0) close(listener);
+            listener = -1;
+            return false;
+        }
+        std::strncpy(addr.sun_path, this->socketPath.c_str(), sizeof(addr.sun_path) - 1);
+        unlink(this->socketPath.c_str());
+        if (bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listener, 4) != 0) {
+            std::cerr << "Unable to listen on metrics socket " << this->socketPath << ": " << std::strerror(errno) << std::endl;
+            close(listener);
+            listener = -1;
+            return false;
+        }
+#else
+        std::cerr << "Metrics sockets are not supported on this platform" << std::endl;
+        return false;
+#endif
+    }
+
+    if (!this->filePath.empty() && !WriteFile()) {
+        Stop();
+        return false;
+    }
+
+    running = true;
+    thread = std::thread(&MetricsExporter::Loop, this);
+    return true;
+}
+
+void MetricsExporter::Stop() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+#if defined(CHIP8_METRICS_SOCKET)
+    if (listener >= 0) {
+        close(listener);
+        unlink(socketPath.c_str());
+        listener = -1;
+    }
+#endif
+}
+
+void MetricsExporter::Loop() {
+    auto next = std::chrono::steady_clock::now();
+    while (running) {
+        // Rates come from the exporter's clock, not the emulator's
+        if (std::chrono::steady_clock::now() >= next) {
+            registry.UpdateRates(interval);
+            if (!filePath.empty()) WriteFile();
+            next += interval;
+        }
+        if (listener >= 0) {
+            ServeSocket();
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+    // Leave final totals behind for whoever reads the file after the host exits
+    if (!filePath.empty()) {
+        registry.UpdateRates(std::chrono::milliseconds(0));
+        WriteFile();
+    }
+}
+
+bool MetricsExporter::WriteFile() {
+    std::string text = registry.Format();
+    std::string temporary = filePath + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Unable to write metrics: " << temporary << std::endl;
+        return false;
+    }
+    bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+    written &= std::fclose(file) == 0;
+#if defined(_WIN32)
+    // Only POSIX rename replaces an existing file
+    std::remove(filePath.c_str());
+#endif
+    return written && std::rename(temporary.c_str(), filePath.c_str()) == 0;
+}
+
+// Waits briefly for a scraper and sends it the current text
+void MetricsExporter::ServeSocket() {
+#if defined(CHIP8_METRICS_SOCKET)
+    pollfd fd = { listener, POLLIN, 0 };
+    if (poll(&fd, 1, 50) <= 0 || !(fd.revents & POLLIN)) return;
+
+    int client = accept(listener, nullptr, nullptr);
+    if (client < 0) return;
+    registry.UpdateRates();
+    std::string text = registry.Format();
+    for (size_t sent = 0; sent < text.size();) {
+        ssize_t n = send(client, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) break;
+        sent += n;
+    }
+    close(client);
+#endif
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "chip8.h"
+
+// What exporters and the GUI read for one instance. Every field is a relaxed atomic so readers
+// on other threads never stall the emulator and never see torn values. Hosts copy Chip8::counters
+// in with Collect() in batches (once a frame or once a request), off the hot path.
+struct InstanceMetrics {
+    // Accumulated from Chip8::Counters by Collect()
+    std::atomic<uint64_t> instructions = 0;
+    std::atomic<uint64_t> draws = 0;
+    std::atomic<uint64_t> emulatedFrames = 0;
+
+    // Maintained by the host
+    std::atomic<uint64_t> wallFrames = 0;
+    std::atomic<uint64_t> textureUploads = 0;
+    std::atomic<uint64_t> skippedFrames = 0;
+    std::atomic<int64_t> schedulerLagMicros = 0;
+
+    // Rates over the last MetricsRegistry::UpdateRates() window
+    std::atomic<double> mips = 0.0;
+    std::atomic<double> emulatedFps = 0.0;
+    std::atomic<double> wallFps = 0.0;
+
+    // Adds what the machine counted since the last Collect() or Rebase(), so the exported totals
+    // only ever grow even when the host points the entry at another machine
+    void Collect(const Chip8::Counters& counters) {
+        auto since = [](uint64_t now, uint64_t last) { return now >= last ? now - last : 0; };
+        Add(instructions, since(counters.instructions, collected.instructions));
+        Add(draws, since(counters.draws, collected.draws));
+        Add(emulatedFrames, since(counters.timerTicks, collected.timerTicks));
+        collected = counters;
+    }
+
+    // Starts counting from this machine's current totals, for a host that switches machines
+    void Rebase(const Chip8::Counters& counters) {
+        collected = counters;
+    }
+
+    void Add(std::atomic<uint64_t>& counter, uint64_t amount = 1) {
+        counter.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+private:
+    // Host thread only: the counters as of the last Collect()
+    Chip8::Counters collected;
+};
+
+// The instances of one host, labelled for export
+class MetricsRegistry {
+public:
+    // The returned reference stays valid for the lifetime of the registry
+    InstanceMetrics& Add(std::string label);
+
+    // Recomputes the rate gauges if at least `window` passed since the last update
+    void UpdateRates(std::chrono::milliseconds window = std::chrono::milliseconds(500));
+
+    // Prometheus text exposition format
+    [[nodiscard]] std::string Format();
+
+private:
+    struct Entry {
+        std::string label;
+        std::unique_ptr<InstanceMetrics> metrics;
+        uint64_t lastInstructions = 0;
+        uint64_t lastEmulatedFrames = 0;
+        uint64_t lastWallFrames = 0;
+    };
+
+    std::mutex mutex;
+    std::vector<Entry> entries;
+    std::chrono::steady_clock::time_point lastUpdate = std::chrono::steady_clock::now();
+};
+
+// Publishes a registry from a background thread: rewrites a text file every interval (via a
+// temporary file and rename, so scrapers never read half a file) and/or answers each connection
+// on a Unix domain socket with the current text (POSIX only).
+class MetricsExporter {
+public:
+    explicit MetricsExporter(MetricsRegistry& registry) : registry(registry) {}
+    ~MetricsExporter();
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    bool Start(std::string_view filePath, std::string_view socketPath, std::chrono::milliseconds interval = std::chrono::seconds(1));
+    void Stop();
+
+private:
+    void Loop();
+    bool WriteFile();
+    void ServeSocket();
+
+    MetricsRegistry& registry;
+    std::string filePath;
+    std::string socketPath;
+    std::chrono::milliseconds interval{ 1000 };
+    int listener = -1;
+    std::atomic<bool> running = false;
+    std::thread thread;
+};
@@ -0,0 +1,26 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "movie.h"
+
+bool ReadMovie(const std::filesystem::path& path, std::vector<MovieInput>& movie) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        MovieInput input;
+        unsigned keys;
+        if (!(fields >> input.frame >> std::hex >> keys) || input.frame < 0 || keys > 0xFFFF) return false;
+        input.keys = static_cast<uint16_t>(keys);
+        movie.push_back(input);
+    }
+    std::sort(movie.begin(), movie.end(), [](const MovieInput& a, const MovieInput& b) { return a.frame < b.frame; });
+
+    // Two masks for one frame would make the run depend on which one a player applies
+    auto duplicate = std::adjacent_find(movie.begin(), movie.end(), [](const MovieInput& a, const MovieInput& b) { return a.frame == b.frame; });
+    return duplicate == movie.end();
+}
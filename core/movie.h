@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+// Input movies: "<frame> <key mask>" lines (mask in hex, bit n = key n), each mask staying held
+// from that frame until the next line. '#' starts a comment line.
+struct MovieInput {
+    long long frame;
+    uint16_t keys;
+};
+
+// Appends the movie's inputs sorted by frame, false if the file can't be read or parsed, or has
+// a negative frame, a mask past 16 bits or two lines for the same frame
+bool ReadMovie(const std::filesystem::path& path, std::vector<MovieInput>& movie);
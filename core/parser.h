@@ -2,7 +2,7 @@
 
 #include "opcode.h"
 
-enum class Instruction {
+enum class Instruction : uint8_t {
     ADD_I_VX,
     ADD_VX_KK,
     ADD_VX_VY,
@@ -37,12 +37,37 @@ enum class Instruction {
     SUBN_VX_VY,
     SUB_VX_VY,
     XOR_VX_VY,
+
+    // SUPER-CHIP and XO-CHIP extensions. Recognised for classification and disassembly only; the
+    // interpreter doesn't execute them, so running one traps as an invalid opcode. The exceptions
+    // are 5xy2/5xy3, which run as 5xy0 (the lax encoding older ROMs use) unless
+    // quirks.registerRanges selects the XO-CHIP meaning.
+    SCD,            // 00Cn     - Scroll down n rows (SCHIP)
+    SCU,            // 00Dn     - Scroll up n rows (XO-CHIP)
+    SCR,            // 00FB     - Scroll right 4 pixels (SCHIP)
+    SCL,            // 00FC     - Scroll left 4 pixels (SCHIP)
+    EXIT,           // 00FD     - Exit the interpreter (SCHIP)
+    LOW,            // 00FE     - 64x32 display (SCHIP)
+    HIGH,           // 00FF     - 128x64 display (SCHIP)
+    SAVE_VX_VY,     // 5xy2     - Store Vx..Vy at I (XO-CHIP)
+    LOAD_VX_VY,     // 5xy3     - Load Vx..Vy from I (XO-CHIP)
+    LD_I_LONG,      // F000 nnnn - I = the 16-bit word that follows (XO-CHIP)
+    PLANE,          // Fn01     - Select drawing planes (XO-CHIP)
+    AUDIO,          // F002     - Load the audio pattern at I (XO-CHIP)
+    LD_HF_VX,       // Fx30     - I = 10-byte font sprite for Vx (SCHIP)
+    PITCH,          // Fx3A     - Audio pitch = Vx (XO-CHIP)
+    LD_R_VX,        // Fx75     - Store V0..Vx in the RPL flags (SCHIP)
+    LD_VX_R,        // Fx85     - Load V0..Vx from the RPL flags (SCHIP)
+
     UNKNOWN
 };
 
+// Oldest platform that defines an instruction. XO-CHIP includes SUPER-CHIP, which includes CHIP-8.
+enum class Platform : uint8_t { Chip8, SuperChip, XoChip };
+
 // Standard Chip-8 instructions reference:
 // http://devernay.free.fr/hacks/chip8/C8TECH10.HTM#3.1
-inline Instruction parse(Opcode opcode) {
+constexpr Instruction parse(Opcode opcode) {
     switch (opcode.high()) {
     case 0x00:
         switch (opcode.byte()) {
@@ -50,8 +75,16 @@ inline Instruction parse(Opcode opcode) {
         case 0xE0: return Instruction::CLS;
             // 00EE - Return from a subroutine.
         case 0xEE: return Instruction::RET;
+        case 0xFB: return Instruction::SCR;
+        case 0xFC: return Instruction::SCL;
+        case 0xFD: return Instruction::EXIT;
+        case 0xFE: return Instruction::LOW;
+        case 0xFF: return Instruction::HIGH;
+        default:
+            if (opcode.x() == 0 && opcode.y() == 0x0C) return Instruction::SCD;
+            if (opcode.x() == 0 && opcode.y() == 0x0D) return Instruction::SCU;
             // UNKNOWN
-        default: return Instruction::UNKNOWN;
+            return Instruction::UNKNOWN;
         }
         // 1nnn - Jump to location nnn.
     case 0x01: return Instruction::JMP;
@@ -61,8 +94,12 @@ inline Instruction parse(Opcode opcode) {
     case 0x03: return Instruction::SE_VX_KK;
         // 4xkk - Skip next instruction if Vx != kk.
     case 0x04: return Instruction::SNE_VX_KK;
-        // 5xy0 - Skip next instruction if Vx = Vy.
-    case 0x05: return Instruction::SE_VX_VY;
+        // 5xy0 - Skip next instruction if Vx = Vy. 5xy2/5xy3 are decoded as the XO-CHIP forms,
+        // ExecuteInstruction() picks the meaning from the quirks.
+    case 0x05:
+        if (opcode.low() == 0x02) return Instruction::SAVE_VX_VY;
+        if (opcode.low() == 0x03) return Instruction::LOAD_VX_VY;
+        return Instruction::SE_VX_VY;
         // 6xkk - The interpreter puts the value kk into register Vx.
     case 0x06: return Instruction::LD_VX_KK;
         // 7xkk - Adds the value kk to the value of register Vx.
@@ -129,9 +166,41 @@ inline Instruction parse(Opcode opcode) {
         case 0x55: return Instruction::LD_I_VX;
             // Fx65 - Read registers V0 through Vx from memory starting at location I.
         case 0x65: return Instruction::LD_VX_I;
+        case 0x00: return opcode.x() == 0 ? Instruction::LD_I_LONG : Instruction::UNKNOWN;
+        case 0x01: return Instruction::PLANE;
+        case 0x02: return opcode.x() == 0 ? Instruction::AUDIO : Instruction::UNKNOWN;
+        case 0x30: return Instruction::LD_HF_VX;
+        case 0x3A: return Instruction::PITCH;
+        case 0x75: return Instruction::LD_R_VX;
+        case 0x85: return Instruction::LD_VX_R;
             // UNKNOWN
         default: return Instruction::UNKNOWN;
         }
     default: return Instruction::UNKNOWN;
     }
-}
\ No newline at end of file
+}
+
+constexpr Platform PlatformOf(Instruction instruction) {
+    switch (instruction) {
+    case Instruction::SCD:
+    case Instruction::SCR:
+    case Instruction::SCL:
+    case Instruction::EXIT:
+    case Instruction::LOW:
+    case Instruction::HIGH:
+    case Instruction::LD_HF_VX:
+    case Instruction::LD_R_VX:
+    case Instruction::LD_VX_R:
+        return Platform::SuperChip;
+    case Instruction::SCU:
+    case Instruction::SAVE_VX_VY:
+    case Instruction::LOAD_VX_VY:
+    case Instruction::LD_I_LONG:
+    case Instruction::PLANE:
+    case Instruction::AUDIO:
+    case Instruction::PITCH:
+        return Platform::XoChip;
+    default:
+        return Platform::Chip8;
+    }
+}
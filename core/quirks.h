@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+// Behaviours that differ between CHIP-8 interpreters. Each flag is off in this interpreter's
+// original behaviour (Profile::Default), so an instance nobody configures runs as it always did.
+struct Quirks {
+    bool vfReset = false;           // 8xy1/8xy2/8xy3 clear VF (COSMAC VIP)
+    bool memoryIncrement = false;   // Fx55/Fx65 leave I pointing past the last register
+    bool shiftVy = false;           // 8xy6/8xyE shift Vy into Vx instead of Vx in place
+    bool jumpVx = false;            // Bxnn jumps to xnn + Vx instead of nnn + V0
+    bool clipSprites = false;       // Sprites are clipped at the edges instead of wrapping
+    bool registerRanges = false;    // 5xy2/5xy3 store/load Vx..Vy at I (XO-CHIP) instead of skipping like 5xy0
+
+    bool operator==(const Quirks&) const = default;
+};
+
+// Named quirk sets, matching the platforms ROMs are usually written for
+enum class Profile : uint8_t { Default, Chip8, SuperChip, XoChip };
+
+constexpr std::array<Profile, 4> kProfiles = { Profile::Default, Profile::Chip8, Profile::SuperChip, Profile::XoChip };
+
+constexpr Quirks QuirksFor(Profile profile) {
+    switch (profile) {
+    case Profile::Chip8: return { .vfReset = true, .memoryIncrement = true, .shiftVy = true, .clipSprites = true };
+    case Profile::SuperChip: return { .jumpVx = true, .clipSprites = true };
+    case Profile::XoChip: return { .memoryIncrement = true, .shiftVy = true, .registerRanges = true };
+    default: return {};
+    }
+}
+
+constexpr std::string_view ProfileName(Profile profile) {
+    switch (profile) {
+    case Profile::Chip8: return "chip8";
+    case Profile::SuperChip: return "schip";
+    case Profile::XoChip: return "xochip";
+    default: return "default";
+    }
+}
+
+constexpr std::optional<Profile> ParseProfile(std::string_view name) {
+    for (Profile profile : kProfiles) {
+        if (ProfileName(profile) == name) return profile;
+    }
+    return std::nullopt;
+}
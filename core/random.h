@@ -1,20 +1,93 @@
 #pragma once
 
-#include <random>
+#include <array>
+#include <cstdint>
+#include <span>
 
-// For opcode CXNN the requires random number between 0-255 (0x00-0xFF) 
+// Random source for opcode CXNN, which requires a random number between 0-255 (0x00-0xFF).
+//
+// xoshiro128** seeded through splitmix64, so the sequence depends only on (seed, stream) and is
+// the same on every compiler and standard library. The whole generator is four words of State,
+// which save states carry, so restoring a state replays the same numbers.
+//
+// Streams give different sequences for the same seed, for batch runs where every instance
+// should see different but reproducible numbers. The stream number is mixed into the seeding
+// so selecting one costs the same for stream 0 and stream 100000. That only guarantees that
+// different streams of one seed start from different states: they are not spaced apart on the
+// generator's cycle, so two sequences may overlap, and a (seed, stream) pair can reproduce
+// another pair with a different seed.
 class Random {
 public:
-    template <typename T>
-    void seed(T val) {
-        rand_engine.seed(val);
+    using State = std::array<uint32_t, 4>;
+
+    Random() {
+        seed(0);
+    }
+
+    void seed(uint64_t value, uint64_t stream = 0) {
+        seedValue = value;
+        streamValue = stream;
+        uint64_t mix = value ^ SplitMix(stream);
+        for (int i = 0; i < 4; i += 2) {
+            uint64_t word = SplitMix(mix);
+            state[i] = static_cast<uint32_t>(word);
+            state[i + 1] = static_cast<uint32_t>(word >> 32);
+        }
+        // The all-zero state is a fixed point
+        if ((state[0] | state[1] | state[2] | state[3]) == 0) {
+            state[0] = 1;
+        }
+    }
+
+    // Back to the start of the current seed and stream
+    void reset() {
+        seed(seedValue, streamValue);
     }
 
     [[nodiscard]] uint8_t operator()() {
-        return static_cast<uint8_t>(rand_dist(rand_engine));
+        return static_cast<uint8_t>(Next() >> 24);
+    }
+
+    // Same bytes, in the same order, as calling operator() once per element
+    void fill(std::span<uint8_t> out) {
+        for (auto& byte : out) {
+            byte = static_cast<uint8_t>(Next() >> 24);
+        }
+    }
+
+    [[nodiscard]] const State& save() const {
+        return state;
+    }
+
+    void restore(const State& saved) {
+        state = saved;
     }
 
 private:
-    std::default_random_engine rand_engine;
-    std::uniform_int_distribution<int> rand_dist{0, 255};
+    static uint32_t Rotl(uint32_t x, int k) {
+        return (x << k) | (x >> (32 - k));
+    }
+
+    static uint64_t SplitMix(uint64_t& x) {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    uint32_t Next() {
+        uint32_t result = Rotl(state[1] * 5, 7) * 9;
+        uint32_t t = state[1] << 9;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = Rotl(state[3], 11);
+        return result;
+    }
+
+    State state = { 0, 0, 0, 0 };
+    uint64_t seedValue = 0;
+    uint64_t streamValue = 0;
 };
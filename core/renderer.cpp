@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include "renderer.h"
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define CHIP8_RENDERER_SSE2
+#endif
+
+namespace Renderer {
+
+namespace {
+
+// Turns one row of display bytes (0 = off) into colours
+void ExpandRow(const uint8_t* pixels, uint32_t foreground, uint32_t background, uint32_t* out) {
+    int x = 0;
+#if defined(__AVX2__)
+    const __m256i fg = _mm256_set1_epi32(static_cast<int>(foreground));
+    const __m256i bg = _mm256_set1_epi32(static_cast<int>(background));
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 8 <= Chip8::kWidth; x += 8) {
+        // 0xFF for lit pixels, sign-extended to a full lane mask
+        __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pixels + x));
+        __m128i lit = _mm_andnot_si128(_mm_cmpeq_epi8(bytes, zero), _mm_set1_epi8(-1));
+        __m256i mask = _mm256_cvtepi8_epi32(lit);
+        __m256i colour = _mm256_blendv_epi8(bg, fg, mask);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x), colour);
+    }
+#elif defined(CHIP8_RENDERER_SSE2)
+    const __m128i fg = _mm_set1_epi32(static_cast<int>(foreground));
+    const __m128i bg = _mm_set1_epi32(static_cast<int>(background));
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 16 <= Chip8::kWidth; x += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + x));
+        __m128i off = _mm_cmpeq_epi8(bytes, zero);
+
+        // Widen the byte masks to 32-bit lanes, four pixels at a time
+        __m128i low = _mm_unpacklo_epi8(off, off);
+        __m128i high = _mm_unpackhi_epi8(off, off);
+        __m128i masks[4] = {
+            _mm_unpacklo_epi16(low, low), _mm_unpackhi_epi16(low, low),
+            _mm_unpacklo_epi16(high, high), _mm_unpackhi_epi16(high, high),
+        };
+        for (int i = 0; i < 4; ++i) {
+            __m128i colour = _mm_or_si128(_mm_and_si128(masks[i], bg), _mm_andnot_si128(masks[i], fg));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x + i * 4), colour);
+        }
+    }
+#endif
+    for (; x < Chip8::kWidth; ++x) {
+        out[x] = pixels[x] ? foreground : background;
+    }
+}
+
+// Repeats every colour `scale` times
+void ScaleRow(const uint32_t* colours, int scale, uint32_t* out) {
+#if defined(__AVX2__) || defined(CHIP8_RENDERER_SSE2)
+    if (scale >= 4) {
+        for (int x = 0; x < Chip8::kWidth; ++x) {
+            __m128i colour = _mm_set1_epi32(static_cast<int>(colours[x]));
+            int i = 0;
+            for (; i + 4 <= scale; i += 4) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), colour);
+            }
+            for (; i < scale; ++i) {
+                out[i] = colours[x];
+            }
+            out += scale;
+        }
+        return;
+    }
+    if (scale == 2) {
+        for (int x = 0; x < Chip8::kWidth; x += 4) {
+            __m128i four = _mm_loadu_si128(reinterpret_cast<const __m128i*>(colours + x));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 2), _mm_unpacklo_epi32(four, four));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 2 + 4), _mm_unpackhi_epi32(four, four));
+        }
+        return;
+    }
+#endif
+    for (int x = 0; x < Chip8::kWidth; ++x) {
+        std::fill_n(out + x * scale, scale, colours[x]);
+    }
+}
+
+// Halves RGB, keeping alpha
+uint32_t Dim(uint32_t colour) {
+    return ((colour >> 1) & 0x007F7F7F) | (colour & 0xFF000000);
+}
+
+void DimRow(const uint32_t* in, int width, uint32_t* out) {
+    int x = 0;
+#if defined(__AVX2__) || defined(CHIP8_RENDERER_SSE2)
+    const __m128i rgb = _mm_set1_epi32(0x007F7F7F);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+    for (; x + 4 <= width; x += 4) {
+        __m128i colour = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + x));
+        __m128i dimmed = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(colour, 1), rgb), _mm_and_si128(colour, alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), dimmed);
+    }
+#endif
+    for (; x < width; ++x) {
+        out[x] = Dim(in[x]);
+    }
+}
+
+} // namespace
+
+void Render(const Chip8::Display& display, const Options& options, uint32_t* out, size_t stride) {
+    int scale = std::clamp(options.scale, 1, kMaxScale);
+    int width = Chip8::kWidth * scale;
+    bool filtered = options.filter != Filter::None && scale >= 2;
+
+    std::array<uint32_t, Chip8::kWidth> colours;
+    std::array<uint32_t, Chip8::kWidth * kMaxScale> line;
+    std::array<uint32_t, Chip8::kWidth * kMaxScale> dimmed;
+
+    for (int y = 0; y < Chip8::kHeight; ++y) {
+        uint32_t* row = out + size_t(y) * scale * stride;
+        ExpandRow(display.data() + y * Chip8::kWidth, options.foreground, options.background, colours.data());
+        if (scale == 1) {
+            std::memcpy(row, colours.data(), sizeof(colours));
+            continue;
+        }
+
+        ScaleRow(colours.data(), scale, line.data());
+        if (options.filter == Filter::Grid) {
+            for (int x = scale - 1; x < width; x += scale) {
+                line[x] = Dim(line[x]);
+            }
+        }
+        if (filtered) {
+            DimRow(line.data(), width, dimmed.data());
+        }
+
+        // The last line of each scaled row carries the scanline or grid line
+        for (int i = 0; i < scale; ++i) {
+            const uint32_t* source = filtered && i == scale - 1 ? dimmed.data() : line.data();
+            std::memcpy(row + size_t(i) * stride, source, width * sizeof(uint32_t));
+        }
+    }
+}
+
+void Render(const Chip8::Display& display, const Options& options, std::vector<uint32_t>& out) {
+    int scale = std::clamp(options.scale, 1, kMaxScale);
+    out.resize(size_t(Chip8::kWidth) * Chip8::kHeight * scale * scale);
+    Render(display, options, out.data(), Chip8::kWidth * scale);
+}
+
+bool ParseFilter(std::string_view name, Filter& filter) {
+    if (name == "none") filter = Filter::None;
+    else if (name == "scanlines") filter = Filter::Scanlines;
+    else if (name == "grid") filter = Filter::Grid;
+    else return false;
+    return true;
+}
+
+bool ParseColour(std::string_view text, uint32_t& colour) {
+    if (text.starts_with('#')) text.remove_prefix(1);
+    if (text.size() != 6) return false;
+
+    uint8_t channels[3];
+    for (int i = 0; i < 3; ++i) {
+        int value = 0;
+        for (char c : text.substr(i * 2, 2)) {
+            int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+            if (digit < 0) return false;
+            value = value * 16 + digit;
+        }
+        channels[i] = static_cast<uint8_t>(value);
+    }
+    colour = Rgba(channels[0], channels[1], channels[2]);
+    return true;
+}
+
+ContactSheet::ContactSheet(const Options& options, int columns, int padding) : options(options), columns(std::max(1, columns)), padding(std::max(0, padding)) {
+    int scale = std::clamp(options.scale, 1, kMaxScale);
+    cellWidth = Chip8::kWidth * scale + this->padding;
+    cellHeight = Chip8::kHeight * scale + this->padding;
+    width = this->columns * cellWidth + this->padding;
+}
+
+int ContactSheet::Height() const {
+    int rows = (frames + columns - 1) / columns;
+    return std::max(rows, 1) * cellHeight + padding;
+}
+
+void ContactSheet::Add(const Chip8::Display& display) {
+    int row = frames / columns;
+    int column = frames % columns;
+    frames++;
+
+    // Grow by whole rows, filled with the background colour
+    pixels.resize(size_t(width) * Height(), options.background);
+    uint32_t* cell = pixels.data() + size_t(padding + row * cellHeight) * width + padding + column * cellWidth;
+    Render(display, options, cell, width);
+}
+
+Atlas::Atlas(const Options& options, int tiles, int columns) : options(options), tiles(std::max(1, tiles)), columns(std::clamp(columns, 1, std::max(1, tiles))) {
+    this->options.scale = 1;
+    rows = (this->tiles + this->columns - 1) / this->columns;
+    pixels.resize(size_t(Width()) * Height(), options.background);
+    shown.resize(this->tiles);
+    stale.assign(this->tiles, true);
+    dirtyFirst = Height();
+    dirtyLast = 0;
+}
+
+void Atlas::Invalidate(const Options& options) {
+    this->options = options;
+    this->options.scale = 1;
+    stale.assign(tiles, true);
+}
+
+void Atlas::Update(int tile, const Chip8::Display& display) {
+    if (tile < 0 || tile >= tiles) return;
+    if (!stale[tile] && shown[tile] == display) return;
+
+    shown[tile] = display;
+    stale[tile] = false;
+    int top = tile / columns * kTileHeight;
+    Render(display, options, pixels.data() + size_t(top) * Width() + tile % columns * kTileWidth, Width());
+    dirtyFirst = std::min(dirtyFirst, top);
+    dirtyLast = std::max(dirtyLast, top + kTileHeight);
+}
+
+std::pair<int, int> Atlas::TakeDirtyRows() {
+    std::pair<int, int> rows = { std::min(dirtyFirst, dirtyLast), dirtyLast };
+    dirtyFirst = Height();
+    dirtyLast = 0;
+    return rows;
+}
+
+} // namespace Renderer
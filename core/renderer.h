@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "chip8.h"
+
+// CPU renderer for the Chip-8 display, for screenshots and recordings without a GL context.
+//
+// Pixels are 32-bit RGBA with R in the lowest byte, i.e. the bytes are R, G, B, A in memory on
+// little-endian hosts, the layout GL_RGBA/GL_UNSIGNED_BYTE and the image writers expect.
+namespace Renderer {
+
+enum class Filter { None, Scanlines, Grid };
+
+constexpr uint32_t Rgba(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) {
+    return uint32_t(r) | uint32_t(g) << 8 | uint32_t(b) << 16 | uint32_t(a) << 24;
+}
+
+// Defaults match the GUI's colours
+constexpr uint32_t kForeground = Rgba(255, 0, 0);
+constexpr uint32_t kBackground = Rgba(12, 12, 12);
+constexpr int kMaxScale = 20;
+
+struct Options {
+    int scale = 1;                      // 1-kMaxScale
+    uint32_t foreground = kForeground;
+    uint32_t background = kBackground;
+    Filter filter = Filter::None;       // Only visible from scale 2 up
+};
+
+// Writes (kWidth * scale) x (kHeight * scale) pixels starting at out, rows `stride` pixels apart
+void Render(const Chip8::Display& display, const Options& options, uint32_t* out, size_t stride);
+
+// Convenience for a tightly packed image, resized to fit
+void Render(const Chip8::Display& display, const Options& options, std::vector<uint32_t>& out);
+
+// Parses "none", "scanlines" or "grid"
+bool ParseFilter(std::string_view name, Filter& filter);
+
+// Parses "RRGGBB" (optionally prefixed with '#')
+bool ParseColour(std::string_view text, uint32_t& colour);
+
+// Lays out frames in a grid, `columns` wide, with `padding` background pixels around each cell
+class ContactSheet {
+public:
+    ContactSheet(const Options& options, int columns, int padding = 4);
+
+    void Add(const Chip8::Display& display);
+
+    [[nodiscard]] int Width() const { return width; }
+    [[nodiscard]] int Height() const;
+    [[nodiscard]] int Frames() const { return frames; }
+    // Row-major RGBA, Width() x Height()
+    [[nodiscard]] const std::vector<uint32_t>& Pixels() const { return pixels; }
+
+private:
+    Options options;
+    int columns;
+    int padding;
+    int width;
+    int cellWidth;
+    int cellHeight;
+    int frames = 0;
+    std::vector<uint32_t> pixels;
+};
+
+// Packs the displays of many instances into one image, tiles row-major `columns` wide, for a
+// single texture upload per frame. Update() re-renders a tile only when its display differs from
+// the one it last saw and widens the band of rows the next upload has to cover.
+class Atlas {
+public:
+    Atlas(const Options& options, int tiles, int columns);
+
+    void Update(int tile, const Chip8::Display& display);
+    // Re-renders every tile on the next Update(), e.g. after a colour change
+    void Invalidate(const Options& options);
+
+    // Pixel rows changed since the last call, as [first, last); first == last when none did
+    [[nodiscard]] std::pair<int, int> TakeDirtyRows();
+
+    [[nodiscard]] int Width() const { return columns * kTileWidth; }
+    [[nodiscard]] int Height() const { return rows * kTileHeight; }
+    [[nodiscard]] int Tiles() const { return tiles; }
+    [[nodiscard]] int Columns() const { return columns; }
+    // Row-major RGBA, Width() x Height()
+    [[nodiscard]] const std::vector<uint32_t>& Pixels() const { return pixels; }
+
+    static constexpr int kTileWidth = Chip8::kWidth;
+    static constexpr int kTileHeight = Chip8::kHeight;
+
+private:
+    Options options;
+    int tiles;
+    int columns;
+    int rows;
+    int dirtyFirst;
+    int dirtyLast;
+    std::vector<uint32_t> pixels;
+    std::vector<Chip8::Display> shown;
+    std::vector<bool> stale;
+};
+
+} // namespace Renderer
@@ -0,0 +1,20 @@
+#include <chrono>
+#include "runahead.h"
+
+const Chip8& RunAhead::Run(const Chip8& machine, int cycles) {
+    millis = 0.0;
+    instructions = 0;
+    if (frames == 0) return machine;
+
+    auto start = std::chrono::steady_clock::now();
+    scratch = machine;
+    scratch.trace = nullptr;
+    scratch.debugger = nullptr;
+    for (int frame = 0; frame < frames; ++frame) {
+        scratch.RunFrame(cycles);
+    }
+
+    instructions = scratch.counters.instructions - machine.counters.instructions;
+    millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return scratch;
+}
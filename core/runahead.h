@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include "chip8.h"
+
+// Hides a program's own input lag by presenting the future: every host frame a scratch copy of the
+// machine runs a few more frames with the keypad as it is now, and the host shows the copy's
+// display. The live machine is never rewound, so saving state is the copy (private memory pages
+// only, shared ones stay shared) and restoring it is not running the copy any further.
+// The copy has no trace or debugger attached, and its beeps, redraws and counters stay on it.
+class RunAhead {
+public:
+    // Machine to present from: the scratch copy after running ahead, or machine itself when off
+    const Chip8& Run(const Chip8& machine, int cycles);
+
+    void SetFrames(int frames) { this->frames = frames < 0 ? 0 : frames; }
+    [[nodiscard]] int Frames() const { return frames; }
+
+    // Cost of the last Run(), on top of the live machine's own
+    [[nodiscard]] double Millis() const { return millis; }
+    [[nodiscard]] uint64_t Instructions() const { return instructions; }
+
+private:
+    Chip8 scratch;
+    int frames = 0;
+    double millis = 0.0;
+    uint64_t instructions = 0;
+};
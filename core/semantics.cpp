@@ -0,0 +1,187 @@
+#include <initializer_list>
+#include "boot.h"
+
+// Opcode semantics checked by the compiler: each case runs a few instructions on a BootMachine
+// through the same handlers the interpreter uses, so a handler change that alters behaviour
+// fails the build instead of a ROM. Nothing here generates code.
+
+namespace {
+
+// Loads the program at 0x200, lets `setup` adjust the machine and steps once per instruction
+template <typename Setup>
+constexpr BootMachine Exec(std::initializer_list<uint16_t> program, Setup setup, Quirks quirks = {}) {
+    BootMachine machine;
+    machine.quirks = quirks;
+    machine.Load({});
+    uint16_t address = Chip8::kStartAddress;
+    for (uint16_t opcode : program) {
+        machine.memory.Write(address++, opcode >> 8);
+        machine.memory.Write(address++, opcode & 0xFF);
+    }
+    setup(machine);
+    for (size_t i = 0; i < program.size() && machine.cpuState == Chip8::CpuState::Running; ++i) {
+        machine.Step();
+    }
+    return machine;
+}
+
+constexpr BootMachine Exec(std::initializer_list<uint16_t> program, Quirks quirks = {}) {
+    return Exec(program, [](BootMachine&) {}, quirks);
+}
+
+constexpr Quirks kVip = QuirksFor(Profile::Chip8);
+constexpr Quirks kSchip = QuirksFor(Profile::SuperChip);
+constexpr Quirks kXo = QuirksFor(Profile::XoChip);
+
+// 00E0, 00EE, 1nnn, 2nnn
+static_assert(Exec({ 0x00E0 }, [](BootMachine& m) { m.display.fill(1); }).display == Chip8::Display{});
+static_assert(Exec({ 0x1234 }).pc == 0x234);
+static_assert(Exec({ 0x2208, 0x0000, 0x0000, 0x0000, 0x00EE }).pc == 0x202);
+static_assert(Exec({ 0x2300 }).stack[0] == 0x202 && Exec({ 0x2300 }).sp == 1);
+
+// 3xkk, 4xkk, 5xy0, 9xy0
+static_assert(Exec({ 0x6A12, 0x3A12 }).pc == 0x206);
+static_assert(Exec({ 0x6A12, 0x3A13 }).pc == 0x204);
+static_assert(Exec({ 0x6A12, 0x4A13 }).pc == 0x206);
+static_assert(Exec({ 0x6A12, 0x4A12 }).pc == 0x204);
+static_assert(Exec({ 0x6A12, 0x6B12, 0x5AB0 }).pc == 0x208);
+static_assert(Exec({ 0x6A12, 0x6B13, 0x5AB0 }).pc == 0x206);
+static_assert(Exec({ 0x6A12, 0x6B13, 0x9AB0 }).pc == 0x208);
+static_assert(Exec({ 0x6A12, 0x6B12, 0x9AB0 }).pc == 0x206);
+
+// 5xy2, 5xy3: the lax 5xy0 everywhere but XO-CHIP, which stores/loads Vx..Vy at I in either order
+static_assert(Exec({ 0x6A12, 0x6B12, 0x5AB2 }).pc == 0x208);
+static_assert(Exec({ 0x6A12, 0x6B13, 0x5AB3 }).pc == 0x206);
+static_assert(Exec({ 0x6A12, 0x6B12, 0x5AB2 }, kVip).pc == 0x208 && Exec({ 0x6A12, 0x6B12, 0x5AB3 }, kSchip).pc == 0x208);
+static_assert(Exec({ 0x6A12, 0x6B12, 0x5AB2 }, kXo).pc == 0x206);
+static_assert(Exec({ 0x6111, 0x6222, 0x6333, 0xA300, 0x5132 }, kXo).memory[0x302] == 0x33);
+static_assert(Exec({ 0x6111, 0x6222, 0x6333, 0xA300, 0x5312 }, kXo).memory[0x300] == 0x33);
+static_assert(Exec({ 0x6111, 0x6222, 0x6333, 0xA300, 0x5312 }, kXo).index == 0x300);
+static_assert(Exec({ 0xA050, 0x5233 }, kXo).registers[2] == 0xF0 && Exec({ 0xA050, 0x5233 }, kXo).registers[3] == 0x90);
+static_assert(Exec({ 0xA050, 0x5323 }, kXo).registers[3] == 0xF0 && Exec({ 0xA050, 0x5323 }, kXo).registers[2] == 0x90);
+static_assert(Exec({ 0xAFFF, 0x5012 }, kXo).trap == Chip8::Trap::OutOfRange);
+
+// 6xkk, 7xkk (no carry), 8xy0
+static_assert(Exec({ 0x6C7F }).registers[0xC] == 0x7F);
+static_assert(Exec({ 0x63FF, 0x7302 }).registers[3] == 0x01 && Exec({ 0x63FF, 0x7302 }).registers[0xF] == 0);
+static_assert(Exec({ 0x6155, 0x8210 }).registers[2] == 0x55);
+
+// 8xy1, 8xy2, 8xy3, with and without the VF reset
+static_assert(Exec({ 0x600C, 0x610A, 0x8011 }).registers[0] == 0x0E);
+static_assert(Exec({ 0x600C, 0x610A, 0x8012 }).registers[0] == 0x08);
+static_assert(Exec({ 0x600C, 0x610A, 0x8013 }).registers[0] == 0x06);
+static_assert(Exec({ 0x6F05, 0x8011 }).registers[0xF] == 5);
+static_assert(Exec({ 0x6F05, 0x8011 }, kVip).registers[0xF] == 0);
+static_assert(Exec({ 0x6F05, 0x8012 }, kVip).registers[0xF] == 0);
+static_assert(Exec({ 0x6F05, 0x8013 }, kVip).registers[0xF] == 0);
+
+// 8xy4, 8xy5, 8xy7: VF is the carry / not borrow
+static_assert(Exec({ 0x60F0, 0x6120, 0x8014 }).registers[0] == 0x10 && Exec({ 0x60F0, 0x6120, 0x8014 }).registers[0xF] == 1);
+static_assert(Exec({ 0x6010, 0x6120, 0x8014 }).registers[0] == 0x30 && Exec({ 0x6010, 0x6120, 0x8014 }).registers[0xF] == 0);
+static_assert(Exec({ 0x6030, 0x6110, 0x8015 }).registers[0] == 0x20 && Exec({ 0x6030, 0x6110, 0x8015 }).registers[0xF] == 1);
+static_assert(Exec({ 0x6010, 0x6130, 0x8015 }).registers[0] == 0xE0 && Exec({ 0x6010, 0x6130, 0x8015 }).registers[0xF] == 0);
+static_assert(Exec({ 0x6010, 0x6130, 0x8017 }).registers[0] == 0x20 && Exec({ 0x6010, 0x6130, 0x8017 }).registers[0xF] == 1);
+static_assert(Exec({ 0x6030, 0x6110, 0x8017 }).registers[0] == 0xE0 && Exec({ 0x6030, 0x6110, 0x8017 }).registers[0xF] == 0);
+
+// With VF as the destination the result lands after the flag and overwrites it
+static_assert(Exec({ 0x6FFF, 0x6101, 0x8F14 }).registers[0xF] == 0);
+
+// 8xy6, 8xyE: in place, or from Vy with shiftVy
+static_assert(Exec({ 0x6005, 0x8006 }).registers[0] == 0x02 && Exec({ 0x6005, 0x8006 }).registers[0xF] == 1);
+static_assert(Exec({ 0x6081, 0x800E }).registers[0] == 0x02 && Exec({ 0x6081, 0x800E }).registers[0xF] == 1);
+static_assert(Exec({ 0x6004, 0x6103, 0x8016 }).registers[0] == 0x02);
+static_assert(Exec({ 0x6004, 0x6103, 0x8016 }, kVip).registers[0] == 0x01 && Exec({ 0x6004, 0x6103, 0x8016 }, kVip).registers[0xF] == 1);
+static_assert(Exec({ 0x6004, 0x6140, 0x801E }, kVip).registers[0] == 0x80);
+
+// Annn, Bnnn (V0, or Vx with jumpVx), Fx1E
+static_assert(Exec({ 0xA123 }).index == 0x123);
+static_assert(Exec({ 0x6004, 0x6210, 0xB300 }).pc == 0x304);
+static_assert(Exec({ 0x6004, 0x6310, 0xB300 }, kSchip).pc == 0x310);
+static_assert(Exec({ 0xA100, 0x6020, 0xF01E }).index == 0x120);
+
+// Dxyn: XOR drawing, collision, wrapping or clipping at the edges
+static_assert(Exec({ 0xA050, 0xD005 }).display[0] == 1 && Exec({ 0xA050, 0xD005 }).display[4] == 0);
+static_assert(Exec({ 0xA050, 0xD005 }).registers[0xF] == 0);
+static_assert(Exec({ 0xA050, 0xD005, 0xD005 }).registers[0xF] == 1);
+static_assert(Exec({ 0xA050, 0xD005, 0xD005 }).display == Chip8::Display{});
+static_assert(Exec({ 0xA050, 0x603E, 0xD011 }).display[1] == 1);
+static_assert(Exec({ 0xA050, 0x603E, 0xD011 }, kSchip).display[1] == 0);
+static_assert(Exec({ 0xA050, 0x6044, 0xD011 }).display[4] == 1);
+static_assert(Exec({ 0xA050, 0xD005 }).counters.draws == 1 && Exec({ 0xA050, 0xD005 }).redraw);
+
+// Ex9E, ExA1 read the keypad
+static_assert(Exec({ 0x6007, 0xE09E }, [](BootMachine& m) { m.keypad[7] = 1; }).pc == 0x206);
+static_assert(Exec({ 0x6007, 0xE09E }).pc == 0x204);
+static_assert(Exec({ 0x6007, 0xE0A1 }).pc == 0x206);
+static_assert(Exec({ 0x6007, 0xE0A1 }, [](BootMachine& m) { m.keypad[7] = 1; }).pc == 0x204);
+
+// Fx07, Fx0A, Fx15, Fx18
+static_assert(Exec({ 0xF507 }, [](BootMachine& m) { m.delayTimer = 9; }).registers[5] == 9);
+static_assert(Exec({ 0xF50A }).cpuState == Chip8::CpuState::WaitingForKey && Exec({ 0xF50A }).waitRegister == 5);
+static_assert(Exec({ 0x6533, 0xF515 }).delayTimer == 0x33);
+static_assert(Exec({ 0x6533, 0xF518 }).soundTimer == 0x33);
+
+// Fx29 points I at the font sprite for the low nibble of Vx, Fx33
+static_assert(Exec({ 0x600A, 0xF029 }).index == 0x50 + 50);
+static_assert(Exec({ 0x601A, 0xF029 }).index == 0x50 + 50);
+static_assert(Exec({ 0x6007, 0xF029, 0xD115 }).display[0] == 1 && Exec({ 0x6007, 0xF029, 0xD115 }).display[4] == 0);
+static_assert(Exec({ 0x60FE, 0xA300, 0xF033 }).memory[0x300] == 2);
+static_assert(Exec({ 0x60FE, 0xA300, 0xF033 }).memory[0x301] == 5);
+static_assert(Exec({ 0x60FE, 0xA300, 0xF033 }).memory[0x302] == 4);
+
+// Fx55, Fx65, and whether they advance I
+static_assert(Exec({ 0x6011, 0x6122, 0xA300, 0xF155 }).memory[0x301] == 0x22);
+static_assert(Exec({ 0x6011, 0x6122, 0xA300, 0xF155 }).index == 0x300);
+static_assert(Exec({ 0x6011, 0x6122, 0xA300, 0xF155 }, kVip).index == 0x302);
+static_assert(Exec({ 0xA050, 0xF165 }).registers[1] == 0x90);
+static_assert(Exec({ 0xA050, 0xF165 }, kVip).index == 0x052);
+
+// Traps: nothing executes, pc points at the faulting instruction
+constexpr BootMachine kUnderflow = Exec({ 0x00EE });
+static_assert(kUnderflow.trap == Chip8::Trap::StackUnderflow && kUnderflow.pc == 0x200);
+constexpr BootMachine kOverflow = Exec({ 0x2200 }, [](BootMachine& m) { m.sp = 16; });
+static_assert(kOverflow.trap == Chip8::Trap::StackOverflow && kOverflow.pc == 0x200);
+static_assert(Exec({ 0x0123 }).trap == Chip8::Trap::InvalidOpcode);
+static_assert(Exec({ 0x00FF }).trap == Chip8::Trap::InvalidOpcode);
+static_assert(Exec({ 0xAFFE, 0xF033 }).trap == Chip8::Trap::OutOfRange && Exec({ 0xAFFE, 0xF033 }).pc == 0x202);
+static_assert(Exec({ 0xAFFF, 0xF155 }).trap == Chip8::Trap::OutOfRange && Exec({ 0xAFFF, 0xF155 }).memory[0xFFF] == 0);
+static_assert(Exec({ 0xAFFF, 0xF165 }).trap == Chip8::Trap::OutOfRange);
+static_assert(Exec({ 0x60FF, 0xBFFF, 0x0000 }).trap == Chip8::Trap::OutOfRange);
+static_assert(Exec({ 0x60FF, 0xBFFF, 0x0000 }).pc == 0x10FE);
+static_assert(Exec({ 0x00EE }).counters.instructions == 0);
+
+// Save states from outside are only loaded with every index and enum in range
+template <typename Change>
+constexpr bool ValidAfter(Change change) {
+    Chip8::State state = BootMachine{}.ToState();
+    // BootMachine has no generator, the host fills rng in before loading
+    state.rng = { 1, 2, 3, 4 };
+    change(state);
+    return Chip8::ValidState(state);
+}
+
+static_assert(ValidAfter([](Chip8::State&) {}));
+static_assert(ValidAfter([](Chip8::State& s) { s.sp = 16; }));
+static_assert(!ValidAfter([](Chip8::State& s) { s.sp = 17; }));
+static_assert(!ValidAfter([](Chip8::State& s) { s.waitRegister = 16; }));
+static_assert(ValidAfter([](Chip8::State& s) { s.waitKey = 15; }));
+static_assert(!ValidAfter([](Chip8::State& s) { s.waitKey = 16; }));
+static_assert(!ValidAfter([](Chip8::State& s) { s.waitKey = -2; }));
+static_assert(!ValidAfter([](Chip8::State& s) { s.cpuState = Chip8::CpuState(3); }));
+static_assert(!ValidAfter([](Chip8::State& s) { s.trap = Chip8::Trap(5); }));
+static_assert(!ValidAfter([](Chip8::State& s) { s.trap = Chip8::Trap::OutOfRange; }));
+static_assert(ValidAfter([](Chip8::State& s) { s.trap = Chip8::Trap::OutOfRange; s.cpuState = Chip8::CpuState::Trapped; }));
+static_assert(!ValidAfter([](Chip8::State& s) { s.display[100] = 2; }));
+static_assert(!ValidAfter([](Chip8::State& s) { s.rng = {}; }));
+static_assert(ValidAfter([](Chip8::State& s) { s.rng = { 0, 0, 0, 1 }; }));
+static_assert(kUnderflow.sp == 0 && ValidAfter([](Chip8::State& s) { s = kUnderflow.ToState(); s.rng = { 1, 0, 0, 0 }; }));
+
+// Boot baking stops before anything that depends on the host
+constexpr std::array<uint8_t, 6> kRandom = { 0x60, 0x01, 0xC1, 0xFF, 0x12, 0x04 };
+static_assert(Bake(kRandom).instructions == 1 && Bake(kRandom).state.pc == 0x202);
+constexpr std::array<uint8_t, 6> kKey = { 0x6A, 0x03, 0xF0, 0x0A, 0x12, 0x04 };
+static_assert(Bake(kKey).instructions == 1 && Bake(kKey).state.registers[0xA] == 3);
+constexpr std::array<uint8_t, 6> kTimer = { 0x60, 0x3C, 0xF0, 0x15, 0x12, 0x04 };
+static_assert(Bake(kTimer, 16, 10).frames == 10 && Bake(kTimer, 16, 10).state.delayTimer == 50);
+
+} // namespace
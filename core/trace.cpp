@@ -0,0 +1,91 @@
+#include <iostream>
+#include <string>
+#include "trace.h"
+
+TraceRecorder::~TraceRecorder() {
+    Close();
+}
+
+bool TraceRecorder::Open(std::string_view path) {
+    Close();
+
+    file = std::fopen(std::string(path).c_str(), "wb");
+    if (!file) {
+        std::cerr << "Failed to open trace output: " << path << std::endl;
+        return false;
+    }
+
+    ring.assign(kChunks * kChunkSize, 0);
+    head = tail = pending = used = 0;
+    stopping = false;
+    failed = std::fwrite(kTraceMagic, 1, sizeof(kTraceMagic), file) != sizeof(kTraceMagic);
+    nextPc = lastIndex = 0;
+    lastRegisters[0] = lastRegisters[1] = 0;
+    records = 0;
+
+    writer = std::thread(&TraceRecorder::WriterLoop, this);
+    return true;
+}
+
+bool TraceRecorder::Close() {
+    if (!file) return !failed;
+
+    if (used > 0) {
+        Submit();
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    writer.join();
+
+    if (std::fclose(file) != 0 && !failed) {
+        std::cerr << "Trace write failed on close." << std::endl;
+        failed = true;
+    }
+    file = nullptr;
+    ring.clear();
+    ring.shrink_to_fit();
+    return !failed;
+}
+
+// Hands the current chunk to the writer and moves on to the next one, waiting only if the ring is full
+void TraceRecorder::Submit() {
+    std::unique_lock lock(mutex);
+    chunkUsed[head] = used;
+    pending++;
+    changed.notify_all();
+    changed.wait(lock, [this] { return pending < kChunks; });
+    head = (head + 1) % kChunks;
+    used = 0;
+}
+
+void TraceRecorder::WriterLoop() {
+    std::unique_lock lock(mutex);
+    while (true) {
+        changed.wait(lock, [this] { return pending > 0 || stopping; });
+        if (pending == 0) break;
+
+        // After a failed write the chunks are still consumed, so the emulator never blocks on a dead file
+        size_t chunk = tail;
+        size_t size = chunkUsed[chunk];
+        bool skip = failed;
+        lock.unlock();
+        bool written = skip || std::fwrite(ring.data() + chunk * kChunkSize, 1, size, file) == size;
+        lock.lock();
+        if (!written) {
+            std::cerr << "Trace write failed, stopping." << std::endl;
+            failed = true;
+        }
+
+        tail = (tail + 1) % kChunks;
+        pending--;
+        changed.notify_all();
+    }
+    if (!failed && std::fflush(file) != 0) {
+        std::cerr << "Trace write failed, stopping." << std::endl;
+        failed = true;
+    }
+}
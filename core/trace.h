@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Per-instruction execution trace in a compact delta-encoded binary format.
+//
+// File layout: the 8-byte magic "C8TRACE1", then one record per executed instruction:
+//
+//   uint8_t  flags
+//   uint16_t pc          if flags & kTracePc       (omitted when pc = previous pc + 2)
+//   uint16_t opcode      always
+//   uint16_t index       if flags & kTraceIndex    (I after the instruction, when it changed)
+//   uint16_t mask        if flags & kTraceRegisters
+//   uint8_t  value[n]    one per set bit of mask, V0 first (registers after the instruction)
+//
+// All multi-byte fields are little-endian. Registers and I start at zero.
+//
+// Records are appended to a ring of fixed-size chunks on the emulation thread. Full chunks are
+// written to the file by a background thread, so the emulator never blocks on I/O unless the
+// whole ring is waiting to be written.
+constexpr char kTraceMagic[8] = { 'C', '8', 'T', 'R', 'A', 'C', 'E', '1' };
+constexpr uint8_t kTracePc = 0x01;
+constexpr uint8_t kTraceIndex = 0x02;
+constexpr uint8_t kTraceRegisters = 0x04;
+
+class TraceRecorder {
+public:
+    TraceRecorder() = default;
+    ~TraceRecorder();
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    bool Open(std::string_view path);
+    // Returns false if any write failed; after the first failure (a full disk, a closed pipe)
+    // the writer drops the remaining chunks
+    bool Close();
+
+    // Called after each instruction with the pc it was fetched from and the resulting state
+    void Record(uint16_t pc, uint16_t opcode, const std::array<uint8_t, 16>& registers, uint16_t index) {
+        if (used + kMaxRecord > kChunkSize) {
+            Submit();
+        }
+
+        uint8_t* out = ring.data() + head * kChunkSize + used;
+        uint8_t* flags = out++;
+        *flags = 0;
+
+        if (pc != nextPc) {
+            *flags |= kTracePc;
+            out = Put16(out, pc);
+        }
+        nextPc = pc + 2;
+
+        out = Put16(out, opcode);
+
+        if (index != lastIndex) {
+            *flags |= kTraceIndex;
+            out = Put16(out, index);
+            lastIndex = index;
+        }
+
+        // Compare the register file as two words and only visit the bytes that differ
+        uint64_t current[2];
+        std::memcpy(current, registers.data(), sizeof(current));
+        uint64_t diff[2] = { current[0] ^ lastRegisters[0], current[1] ^ lastRegisters[1] };
+
+        if (diff[0] | diff[1]) {
+            *flags |= kTraceRegisters;
+            uint8_t* mask = out;
+            out += 2;
+            uint16_t changed = 0;
+            for (int word = 0; word < 2; ++word) {
+                while (diff[word]) {
+                    int byte = std::countr_zero(diff[word]) / 8;
+                    int reg = word * 8 + byte;
+                    changed |= 1 << reg;
+                    *out++ = registers[reg];
+                    diff[word] &= ~(uint64_t(0xFF) << (byte * 8));
+                }
+            }
+            Put16(mask, changed);
+            lastRegisters[0] = current[0];
+            lastRegisters[1] = current[1];
+        }
+
+        used = out - (ring.data() + head * kChunkSize);
+        records++;
+    }
+
+    [[nodiscard]] uint64_t Records() const { return records; }
+
+private:
+    static constexpr size_t kChunkSize = 64 * 1024;
+    static constexpr size_t kChunks = 16;
+    static constexpr size_t kMaxRecord = 1 + 2 + 2 + 2 + 2 + 16;
+
+    static uint8_t* Put16(uint8_t* out, uint16_t value) {
+        out[0] = value & 0xFF;
+        out[1] = value >> 8;
+        return out + 2;
+    }
+
+    void Submit();
+    void WriterLoop();
+
+    std::FILE* file = nullptr;
+    std::vector<uint8_t> ring;
+    std::array<size_t, kChunks> chunkUsed = { 0 };
+
+    // Producer side: chunk being filled and bytes used in it
+    size_t head = 0;
+    size_t used = 0;
+
+    // Shared with the writer, guarded by mutex
+    size_t tail = 0;
+    size_t pending = 0;
+    bool stopping = false;
+    bool failed = false;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::thread writer;
+
+    // Decoder-visible state the next record is delta-encoded against
+    uint16_t nextPc = 0;
+    uint16_t lastIndex = 0;
+    uint64_t lastRegisters[2] = { 0, 0 };
+    uint64_t records = 0;
+};
@@ -1,4 +1,10 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <iterator>
+#include <string_view>
+#include <vector>
 #include <GLFW/glfw3.h>
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
@@ -7,11 +13,25 @@
 
 #include "core/chip8.h"
 #include "core/graphics.h"
+#include "core/renderer.h"
 
 int main(int argc, char** argv) {
     // Ensure correct command-line usage
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << "./chip8 <Rom>" << std::endl;
+    std::string_view rom;
+    int instances = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--instances" && i + 1 < argc) {
+            instances = std::atoi(argv[++i]);
+        } else if (rom.empty()) {
+            rom = arg;
+        } else {
+            rom = {};
+            break;
+        }
+    }
+    if (rom.empty() || instances < 1) {
+        std::cerr << "Usage: " << argv[0] << " <Rom> [--instances N]" << std::endl;
         return EXIT_FAILURE;
     }
 
@@ -42,15 +62,9 @@ int main(int argc, char** argv) {
     io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
     //io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;
 
-    // Initialize the display pixel buffer with all pixels set to black (0, 0, 0)
-    GLubyte displayPixels[Chip8::kWidth * Chip8::kHeight * 3] = { 0 };
-
-    // Loop through each pixel in the display (totaling 2048 pixels for a 64x32 resolution)
-    for (int i = 0; i < Chip8::kWidth * Chip8::kHeight; ++i) {
-        displayPixels[i * 3] = 255;        
-        displayPixels[i * 3 + 1] = 255;     
-        displayPixels[i * 3 + 2] = 255;
-    }
+    // Initialize the RGBA display pixel buffer with all pixels set to white, the GUI renders into it on redraw
+    uint32_t displayPixels[Chip8::kWidth * Chip8::kHeight];
+    std::fill(std::begin(displayPixels), std::end(displayPixels), Renderer::Rgba(255, 255, 255));
 
     // Create and setup the OpenGL texture for display
     GLuint displayTexture;
@@ -59,30 +73,37 @@ int main(int argc, char** argv) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, Chip8::kWidth, Chip8::kHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, displayPixels);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, Chip8::kWidth, Chip8::kHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, displayPixels);
 
     // Initialize ImGui GLFW and OpenGL3 renderers
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 130");
 
-    // Setup Chip-8 Interpreter
-    Chip8 chip8(window);
-    chip8.ResetChip8();
+    // Setup Chip-8 Interpreters
+    std::vector<Chip8> machines(instances);
 
-    // Load the specified ROM
-    if (!chip8.LoadRom(argv[1])) {
-        std::cerr << "Unable to load specified ROM: " << argv[1] << std::endl;
+    // Load the specified ROM, every further instance shares its image and gets its own random stream
+    if (!machines[0].LoadRom(rom)) {
+        std::cerr << "Unable to load specified ROM: " << rom << std::endl;
         glfwTerminate();
         return EXIT_FAILURE;
     }
+    for (int i = 1; i < instances; ++i) {
+        machines[i].LoadRom(machines[0].memory.Image());
+        machines[i].rand.seed(0, i);
+    }
 
-    GUI gui(&chip8, displayTexture, displayPixels, window);    
+    GUI gui(machines, displayTexture, displayPixels, window);
     
     // Main rendering loop
     auto clearColor = ImVec4(0.024f, 0.024f, 0.03f, 1.00f);
     while (!glfwWindowShouldClose(window)) {
-        // Handle window events
-        glfwPollEvents();
+        // Handle window events, sleeping until the next one while emulation is paused
+        if (gui.IsIdle()) {
+            glfwWaitEventsTimeout(0.1);
+        } else {
+            glfwPollEvents();
+        }
 
         // Start the Dear ImGui frame
         ImGui_ImplOpenGL3_NewFrame();
@@ -111,6 +132,7 @@ int main(int argc, char** argv) {
 
         // Swap the front and back buffers
         glfwSwapBuffers(window);
+        gui.Presented();
     }
 
 
@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../core/catalog.h"
+#include "../core/chip8.h"
+#include "../core/classifier.h"
+#include "../core/hash.h"
+
+namespace {
+
+bool ReadRom(const std::filesystem::path& path, std::vector<uint8_t>& rom) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    rom.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !rom.empty() && rom.size() <= Chip8::kMaxRomSize;
+}
+
+} // namespace
+
+// Picks a quirk profile for a ROM or every ROM in a directory and prints how each profile scored.
+// With --catalog the winners are stored in the ROM catalog the GUI reads on load; ROMs that
+// already have a profile there keep it unless --force is given.
+int main(int argc, char** argv) {
+    std::string_view target;
+    std::string_view catalogPath;
+    ClassifierOptions options;
+    bool force = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc) {
+            options.frames = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--cycles" && i + 1 < argc) {
+            options.cycles = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--catalog" && i + 1 < argc) {
+            catalogPath = argv[++i];
+        } else if (arg == "--force") {
+            force = true;
+        } else if (target.empty()) {
+            target = arg;
+        } else {
+            target = {};
+            break;
+        }
+    }
+
+    if (target.empty()) {
+        std::cerr << "Usage: " << argv[0] << " <Rom|directory> [--frames N] [--cycles N] [--seed N] [--catalog chip8.catalog] [--force]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    RomCatalog catalog;
+    if (!catalogPath.empty() && !catalog.Load(std::filesystem::path(catalogPath))) {
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::filesystem::path> roms;
+    std::error_code error;
+    if (std::filesystem::is_directory(target, error)) {
+        for (const auto& entry : std::filesystem::directory_iterator(target, error)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".ch8") {
+                roms.push_back(entry.path());
+            }
+        }
+        std::sort(roms.begin(), roms.end());
+    } else {
+        roms.emplace_back(target);
+    }
+
+    int failures = 0;
+    for (const auto& path : roms) {
+        std::vector<uint8_t> rom;
+        if (!ReadRom(path, rom)) {
+            std::cerr << "Unable to load specified ROM: " << path.string() << std::endl;
+            failures++;
+            continue;
+        }
+
+        auto image = Chip8::CreateImage(rom, path.filename().string(), path.string());
+        Classification result = Classify(image, options);
+        const OpcodeScan& scan = result.scan;
+        std::printf("%-28s %-8s  %d chip8 / %d schip / %d xochip reachable, %d unknown\n", path.filename().string().c_str(),
+            std::string(ProfileName(result.profile)).c_str(), scan.platforms[0], scan.platforms[1], scan.platforms[2], scan.unknown);
+        for (const ProfileRun& run : result.runs) {
+            std::printf("    %-8s %7.2f  %4d distinct, %4d blank, %4d noisy", std::string(ProfileName(run.profile)).c_str(), run.score,
+                run.distinctFrames, run.blankFrames, run.noisyFrames);
+            if (run.trap != Chip8::Trap::None) {
+                std::printf(", %s in frame %lld", Chip8::TrapName(run.trap), run.trapFrame);
+            }
+            std::printf("\n");
+        }
+
+        if (!catalogPath.empty()) {
+            RomCatalog::Settings& settings = catalog[HashRom(*image)];
+            if (force || !settings.quirks) settings.quirks = result.profile;
+            if (settings.title.empty()) settings.title = image->title;
+        }
+    }
+
+    if (!catalogPath.empty() && !catalog.Save()) {
+        return EXIT_FAILURE;
+    }
+    return failures == 0 ? 0 : EXIT_FAILURE;
+}
@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Expands a recording made with chip8_headless --collapse-repeats into a standard stream: each
+// "FRAME XREPEAT=n" (Y4M) or "# repeat n" P4 image (PBM) is written out n times without the
+// count, so ffmpeg, mpv and netpbm see every frame. Streams without counts pass through unchanged.
+namespace {
+
+std::FILE* OpenStream(std::string_view path, const char* mode, std::FILE* standard) {
+    if (path == "-") return standard;
+    return std::fopen(std::string(path).c_str(), mode);
+}
+
+// Reads up to and including the next '\n'; false at end of input
+bool ReadLine(std::FILE* in, std::string& line) {
+    line.clear();
+    int c;
+    while ((c = std::fgetc(in)) != EOF) {
+        line.push_back(static_cast<char>(c));
+        if (c == '\n') return true;
+    }
+    return !line.empty();
+}
+
+// Value of a " <key><value>" parameter in a Y4M header or frame line
+long Parameter(const std::string& line, char key, long fallback) {
+    for (size_t at = line.find(' '); at != std::string::npos; at = line.find(' ', at + 1)) {
+        if (at + 1 < line.size() && line[at + 1] == key) return std::atol(line.c_str() + at + 2);
+    }
+    return fallback;
+}
+
+bool Write(std::FILE* out, const void* data, size_t size) {
+    return std::fwrite(data, 1, size, out) == size;
+}
+
+bool ExpandY4M(std::FILE* in, std::FILE* out, const std::string& header) {
+    long width = Parameter(header, 'W', 0);
+    long height = Parameter(header, 'H', 0);
+    if (width <= 0 || height <= 0) {
+        std::cerr << "Y4M header without a frame size." << std::endl;
+        return false;
+    }
+
+    // Plane sizes for the colour spaces ffmpeg writes; headless records Cmono
+    size_t luma = size_t(width) * size_t(height);
+    size_t frameSize = luma + 2 * size_t((width + 1) / 2) * size_t((height + 1) / 2);
+    auto colour = header.find(" C");
+    if (colour != std::string::npos) {
+        std::string_view space(header.c_str() + colour + 2);
+        if (space.starts_with("mono")) frameSize = luma;
+        else if (space.starts_with("444")) frameSize = luma * 3;
+    }
+
+    if (!Write(out, header.data(), header.size())) return false;
+
+    std::vector<uint8_t> frame(frameSize);
+    std::string line;
+    while (ReadLine(in, line)) {
+        if (!line.starts_with("FRAME")) {
+            std::cerr << "Malformed Y4M frame header." << std::endl;
+            return false;
+        }
+
+        // Drop the repeat count, keep any other frame parameters
+        long repeat = 1;
+        auto at = line.find(" XREPEAT=");
+        if (at != std::string::npos) {
+            repeat = std::max(1L, std::atol(line.c_str() + at + 9));
+            auto end = line.find_first_of(" \n", at + 1);
+            line.erase(at, end - at);
+        }
+
+        if (std::fread(frame.data(), 1, frame.size(), in) != frame.size()) {
+            std::cerr << "Truncated Y4M frame." << std::endl;
+            return false;
+        }
+        for (long copy = 0; copy < repeat; ++copy) {
+            if (!Write(out, line.data(), line.size()) || !Write(out, frame.data(), frame.size())) return false;
+        }
+    }
+    return true;
+}
+
+// Skips whitespace and comments between P4 header fields, picking up a "# repeat n" comment
+int ReadP4Field(std::FILE* in, long& repeat) {
+    int c = std::fgetc(in);
+    while (c != EOF) {
+        if (c == '#') {
+            std::string comment;
+            while ((c = std::fgetc(in)) != EOF && c != '\n') comment.push_back(static_cast<char>(c));
+            if (comment.starts_with(" repeat ")) repeat = std::max(1L, std::atol(comment.c_str() + 8));
+        } else if (c > ' ') {
+            break;
+        }
+        c = std::fgetc(in);
+    }
+
+    int value = 0;
+    while (c >= '0' && c <= '9') {
+        value = value * 10 + (c - '0');
+        c = std::fgetc(in);
+    }
+    // The single whitespace byte after the height is consumed here too
+    return c == EOF ? -1 : value;
+}
+
+bool ExpandPBM(std::FILE* in, std::FILE* out) {
+    std::vector<uint8_t> image;
+    int c;
+    while ((c = std::fgetc(in)) != EOF) {
+        if (c <= ' ') continue;
+        if (c != 'P' || std::fgetc(in) != '4') {
+            std::cerr << "Not a P4 image stream." << std::endl;
+            return false;
+        }
+
+        long repeat = 1;
+        int width = ReadP4Field(in, repeat);
+        int height = ReadP4Field(in, repeat);
+        if (width <= 0 || height <= 0) {
+            std::cerr << "Malformed P4 header." << std::endl;
+            return false;
+        }
+
+        image.resize(size_t((width + 7) / 8) * size_t(height));
+        if (std::fread(image.data(), 1, image.size(), in) != image.size()) {
+            std::cerr << "Truncated P4 image." << std::endl;
+            return false;
+        }
+
+        char header[64];
+        int size = std::snprintf(header, sizeof(header), "P4\n%d %d\n", width, height);
+        for (long copy = 0; copy < repeat; ++copy) {
+            if (!Write(out, header, size) || !Write(out, image.data(), image.size())) return false;
+        }
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <in.y4m|in.pbm|-> <out.y4m|out.pbm|->" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::FILE* in = OpenStream(argv[1], "rb", stdin);
+    if (!in) {
+        std::cerr << "Failed to open recording: " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::FILE* out = OpenStream(argv[2], "wb", stdout);
+    if (!out) {
+        std::cerr << "Failed to open output: " << argv[2] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    bool ok;
+    int first = std::fgetc(in);
+    if (first == 'Y') {
+        std::string header;
+        ReadLine(in, header);
+        header.insert(header.begin(), 'Y');
+        ok = header.starts_with("YUV4MPEG2 ");
+        if (!ok) std::cerr << "Not a Y4M stream." << std::endl;
+        ok = ok && ExpandY4M(in, out, header);
+    } else {
+        std::ungetc(first, in);
+        ok = ExpandPBM(in, out);
+    }
+
+    if (in != stdin) std::fclose(in);
+    if (std::fflush(out) != 0 || (out != stdout && std::fclose(out) != 0)) ok = false;
+    if (!ok) {
+        std::cerr << "Expanding " << argv[1] << " failed." << std::endl;
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
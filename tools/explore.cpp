@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <bitset>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "../core/chip8.h"
+#include "../core/hash.h"
+
+namespace {
+
+// Lock-free set of 64-bit state hashes (open addressing, linear probing). Zero marks an empty
+// slot, so a zero hash is stored as 1.
+class StateTable {
+public:
+    explicit StateTable(size_t capacity) : slots(std::bit_ceil(capacity * 2)), mask(slots.size() - 1), limit(capacity) {}
+
+    // True if the hash was not in the table yet. Fails (false) once the table holds `capacity` hashes.
+    bool Insert(uint64_t hash) {
+        if (hash == 0) hash = 1;
+        for (size_t at = hash & mask;; at = (at + 1) & mask) {
+            uint64_t current = slots[at].load(std::memory_order_relaxed);
+            if (current == hash) return false;
+            if (current != 0) continue;
+
+            if (count.load(std::memory_order_relaxed) >= limit) return false;
+            if (slots[at].compare_exchange_strong(current, hash, std::memory_order_relaxed)) {
+                count.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            if (current == hash) return false;
+        }
+    }
+
+    [[nodiscard]] size_t Size() const { return count.load(std::memory_order_relaxed); }
+    [[nodiscard]] bool Full() const { return Size() >= limit; }
+
+private:
+    std::vector<std::atomic<uint64_t>> slots;
+    size_t mask;
+    size_t limit;
+    std::atomic<size_t> count = 0;
+};
+
+// How a state was reached: its parent in the previous level and the keys held on the way
+struct Link {
+    uint32_t parent;
+    uint16_t keys;
+};
+
+struct Options {
+    int depth = 60;
+    int cycles = 16;
+    int hold = 1;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t maxStates = 1 << 20;
+    std::vector<uint16_t> inputs;
+    bool stopOnDisplay = false;
+    uint64_t stopDisplay = 0;
+    int stopPc = -1;
+    std::string movie;
+};
+
+// Hash of a machine state for deduplication. The keypad is overwritten before every step, so it
+// is left out and two states that differ only in the keys that led to them are merged.
+uint64_t Fingerprint(const Chip8& chip8, Chip8::State& scratch) {
+    chip8.SaveState(scratch);
+    scratch.keypad.fill(0);
+    return HashState(scratch);
+}
+
+// Runs `frames` frames with the keys held, instruction by instruction so every pc is seen.
+// Returns true if the stop pc was reached.
+bool Step(Chip8& chip8, uint16_t keys, const Options& options, std::bitset<4096>& pcs) {
+    for (int key = 0; key < 16; ++key) {
+        chip8.keypad[key] = (keys >> key) & 1;
+    }
+    for (int frame = 0; frame < options.hold; ++frame) {
+        for (int cycle = 0; cycle < options.cycles; ++cycle) {
+            pcs.set(chip8.pc & 0xFFF);
+            if (chip8.pc == options.stopPc) return true;
+            chip8.Tick();
+        }
+        chip8.TickTimer();
+    }
+    return false;
+}
+
+bool WriteMovie(const std::string& path, const std::vector<std::vector<Link>>& history, size_t level, uint32_t node, int hold) {
+    std::vector<uint16_t> inputs;
+    for (size_t at = level; at > 0; --at) {
+        inputs.push_back(history[at][node].keys);
+        node = history[at][node].parent;
+    }
+    std::reverse(inputs.begin(), inputs.end());
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open movie output: " << path << std::endl;
+        return false;
+    }
+    file << "# frame keys\n";
+    for (size_t step = 0; step < inputs.size(); ++step) {
+        char line[32];
+        std::snprintf(line, sizeof(line), "%zu %04x\n", step * hold, inputs[step]);
+        file << line;
+    }
+    return true;
+}
+
+} // namespace
+
+// Breadth-first exploration of the states a ROM can reach: every state of one level is branched
+// on each input, stepped, and kept only if its hash is new. Levels are expanded across all cores.
+int main(int argc, char** argv) {
+    std::string_view rom;
+    Options options;
+    std::string_view keys = "0123456789ABCDEF";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--depth" && i + 1 < argc) {
+            options.depth = std::atoi(argv[++i]);
+        } else if (arg == "--cycles" && i + 1 < argc) {
+            options.cycles = std::atoi(argv[++i]);
+        } else if (arg == "--hold" && i + 1 < argc) {
+            options.hold = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            options.threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--max-states" && i + 1 < argc) {
+            options.maxStates = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--keys" && i + 1 < argc) {
+            keys = argv[++i];
+        } else if (arg == "--stop-display" && i + 1 < argc) {
+            options.stopOnDisplay = true;
+            options.stopDisplay = std::strtoull(argv[++i], nullptr, 16);
+        } else if (arg == "--stop-pc" && i + 1 < argc) {
+            options.stopPc = static_cast<int>(std::strtol(argv[++i], nullptr, 16));
+        } else if (arg == "--movie" && i + 1 < argc) {
+            options.movie = argv[++i];
+        } else if (rom.empty()) {
+            rom = arg;
+        } else {
+            rom = {};
+            break;
+        }
+    }
+
+    // No keys held is always one of the branches
+    options.inputs.push_back(0);
+    for (char key : keys) {
+        int value = key >= '0' && key <= '9' ? key - '0' : key >= 'A' && key <= 'F' ? key - 'A' + 10 : key >= 'a' && key <= 'f' ? key - 'a' + 10 : -1;
+        if (value >= 0) options.inputs.push_back(static_cast<uint16_t>(1 << value));
+    }
+
+    if (rom.empty() || options.depth <= 0 || options.cycles <= 0 || options.maxStates == 0) {
+        std::cerr << "Usage: " << argv[0] << " <Rom> [--depth N] [--cycles N] [--hold N] [--keys 0-F] [--threads N] [--max-states N]"
+                  << " [--stop-display HASH] [--stop-pc ADDR] [--movie out.txt]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Chip8> frontier(1);
+    if (!frontier[0].LoadRom(rom)) {
+        std::cerr << "Unable to load specified ROM: " << rom << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    StateTable table(options.maxStates);
+    Chip8::State scratch;
+    table.Insert(Fingerprint(frontier[0], scratch));
+
+    std::vector<std::vector<Link>> history(1, std::vector<Link>(1, Link{ 0, 0 }));
+    std::bitset<4096> coverage;
+    std::atomic<bool> found = false;
+    size_t foundLevel = 0;
+    uint32_t foundNode = 0;
+    std::mutex mutex;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int level = 1; level <= options.depth && !frontier.empty() && !found && !table.Full(); ++level) {
+        std::vector<std::vector<Chip8>> produced(options.threads);
+        std::vector<std::vector<Link>> links(options.threads);
+        std::atomic<size_t> next = 0;
+
+        auto expand = [&](unsigned worker) {
+            std::bitset<4096> pcs;
+            Chip8::State state;
+            for (size_t parent; !found && (parent = next.fetch_add(1, std::memory_order_relaxed)) < frontier.size();) {
+                for (uint16_t input : options.inputs) {
+                    Chip8 child = frontier[parent];
+                    bool stop = Step(child, input, options, pcs);
+                    if (!table.Insert(Fingerprint(child, state)) && !stop) continue;
+
+                    stop |= options.stopOnDisplay && HashDisplay(child.display) == options.stopDisplay;
+                    links[worker].push_back(Link{ static_cast<uint32_t>(parent), input });
+                    produced[worker].push_back(std::move(child));
+
+                    if (stop && !found.exchange(true)) {
+                        std::lock_guard lock(mutex);
+                        foundLevel = level;
+                        foundNode = static_cast<uint32_t>(produced[worker].size() - 1);
+                        // Made relative to the merged level below
+                        foundNode |= worker << 24;
+                    }
+                }
+            }
+            std::lock_guard lock(mutex);
+            coverage |= pcs;
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned worker = 1; worker < options.threads; ++worker) {
+            workers.emplace_back(expand, worker);
+        }
+        expand(0);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        // Concatenate the per-worker results into the next level, in worker order
+        std::vector<Chip8> merged;
+        std::vector<Link> levelLinks;
+        std::vector<uint32_t> offsets;
+        for (unsigned worker = 0; worker < options.threads; ++worker) {
+            offsets.push_back(static_cast<uint32_t>(merged.size()));
+            std::move(produced[worker].begin(), produced[worker].end(), std::back_inserter(merged));
+            levelLinks.insert(levelLinks.end(), links[worker].begin(), links[worker].end());
+        }
+        if (found && foundLevel == size_t(level)) {
+            foundNode = offsets[foundNode >> 24] + (foundNode & 0xFFFFFF);
+        }
+
+        frontier = std::move(merged);
+        history.push_back(std::move(levelLinks));
+
+        std::printf("level %4d: %8zu new states, %10zu total, %4zu unique PCs\n", level, frontier.size(), table.Size(), coverage.count());
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("%zu unique states, %zu unique PCs in %.2f s on %u threads%s\n", table.Size(), coverage.count(), elapsed.count(),
+        options.threads, table.Full() ? " (state table full)" : "");
+
+    if (!found) {
+        if (options.stopOnDisplay || options.stopPc >= 0) {
+            std::printf("Stop condition not reached.\n");
+            return EXIT_FAILURE;
+        }
+        return 0;
+    }
+
+    std::printf("Stop condition reached at level %zu.\n", foundLevel);
+    if (!options.movie.empty() && !WriteMovie(options.movie, history, foundLevel, foundNode, options.hold)) {
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
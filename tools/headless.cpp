@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "../core/chip8.h"
+#include "../core/framesink.h"
+#include "../core/image.h"
+#include "../core/latency.h"
+#include "../core/metrics.h"
+#include "../core/movie.h"
+#include "../core/renderer.h"
+#include "../core/runahead.h"
+#include "../core/trace.h"
+
+// Runs a ROM without a window, optionally recording the display to a Y4M/PBM stream or
+// rendering PNG/PPM screenshots and contact sheets. Paced at 60 Hz by default, --turbo runs
+// as fast as the host allows.
+int main(int argc, char** argv) {
+    std::string_view rom;
+    std::string_view recordPath;
+    std::string_view tracePath;
+    std::string_view screenshotPath;
+    std::string_view sheetPath;
+    std::string_view metricsPath;
+    std::string_view metricsSocket;
+    std::string_view inputPath;
+    Renderer::Options render;
+    Quirks quirks;
+    int sheetEvery = 60;
+    int sheetColumns = 8;
+    long long frames = 60 * 60;
+    int cycles = 16;
+    int runAheadFrames = 0;
+    uint64_t seed = 0;
+    bool turbo = false;
+    bool latency = false;
+    bool collapseRepeats = false;
+    bool valid = true;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc) {
+            frames = std::atoll(argv[++i]);
+        } else if (arg == "--cycles" && i + 1 < argc) {
+            cycles = std::atoi(argv[++i]);
+        } else if (arg == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (arg == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--screenshot" && i + 1 < argc) {
+            screenshotPath = argv[++i];
+        } else if (arg == "--contact-sheet" && i + 1 < argc) {
+            sheetPath = argv[++i];
+        } else if (arg == "--every" && i + 1 < argc) {
+            sheetEvery = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--columns" && i + 1 < argc) {
+            sheetColumns = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--scale" && i + 1 < argc) {
+            render.scale = std::clamp(std::atoi(argv[++i]), 1, Renderer::kMaxScale);
+        } else if (arg == "--filter" && i + 1 < argc) {
+            valid &= Renderer::ParseFilter(argv[++i], render.filter);
+        } else if (arg == "--fg" && i + 1 < argc) {
+            valid &= Renderer::ParseColour(argv[++i], render.foreground);
+        } else if (arg == "--bg" && i + 1 < argc) {
+            valid &= Renderer::ParseColour(argv[++i], render.background);
+        } else if (arg == "--metrics" && i + 1 < argc) {
+            metricsPath = argv[++i];
+        } else if (arg == "--metrics-socket" && i + 1 < argc) {
+            metricsSocket = argv[++i];
+        } else if (arg == "--input" && i + 1 < argc) {
+            inputPath = argv[++i];
+        } else if (arg == "--run-ahead" && i + 1 < argc) {
+            runAheadFrames = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--quirks" && i + 1 < argc) {
+            auto profile = ParseProfile(argv[++i]);
+            valid &= profile.has_value();
+            quirks = QuirksFor(profile.value_or(Profile::Default));
+        } else if (arg == "--collapse-repeats") {
+            collapseRepeats = true;
+        } else if (arg == "--latency") {
+            latency = true;
+        } else if (arg == "--turbo") {
+            turbo = true;
+        } else if (rom.empty()) {
+            rom = arg;
+        } else {
+            rom = {};
+            break;
+        }
+    }
+
+    if (rom.empty() || !valid) {
+        std::cerr << "Usage: " << argv[0] << " <Rom> [--frames N] [--cycles N] [--record out.y4m|out.pbm|-] [--collapse-repeats] [--trace out.c8t] [--seed N] [--turbo]\n"
+                  << "    [--metrics out.prom] [--metrics-socket PATH] [--input movie.txt] [--latency] [--run-ahead N]\n"
+                  << "    [--quirks default|chip8|schip|xochip]\n"
+                  << "    [--screenshot out.png|out.ppm] [--contact-sheet out.png|out.ppm] [--every N] [--columns N]\n"
+                  << "    [--scale 1-20] [--filter none|scanlines|grid] [--fg RRGGBB] [--bg RRGGBB]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Chip8 chip8;
+    chip8.rand.seed(seed);
+    chip8.quirks = quirks;
+    if (!chip8.LoadRom(rom)) {
+        std::cerr << "Unable to load specified ROM: " << rom << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<MovieInput> movie;
+    if (!inputPath.empty() && !ReadMovie(inputPath, movie)) {
+        std::cerr << "Unable to read input movie: " << inputPath << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Without a movie, latency runs tap a random key for 6 frames every half second
+    Random taps;
+    taps.seed(seed, 1);
+    LatencyProbe probe(1.0, 30);
+
+    // Everything downstream of the emulation sees the run-ahead display when it is enabled
+    RunAhead runAhead;
+    runAhead.SetFrames(runAheadFrames);
+    uint64_t runAheadInstructions = 0;
+
+    FrameSink sink;
+    if (!recordPath.empty() && !sink.Open(recordPath, FrameSink::FormatFromPath(recordPath), 60, collapseRepeats)) {
+        return EXIT_FAILURE;
+    }
+
+    TraceRecorder trace;
+    if (!tracePath.empty()) {
+        if (!trace.Open(tracePath)) {
+            return EXIT_FAILURE;
+        }
+        chip8.trace = &trace;
+    }
+
+    MetricsRegistry registry;
+    MetricsExporter exporter(registry);
+    InstanceMetrics* metrics = nullptr;
+    if (!metricsPath.empty() || !metricsSocket.empty()) {
+        metrics = &registry.Add(std::string(rom));
+        if (!exporter.Start(metricsPath, metricsSocket)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    using clock = std::chrono::steady_clock;
+    constexpr auto kFrameTime = std::chrono::nanoseconds(16666667);
+    auto start = clock::now();
+    auto nextFrame = start;
+
+    Renderer::ContactSheet sheet(render, sheetColumns);
+    // The last frame presented, run-ahead included, for the screenshot
+    Chip8::Display lastShown = chip8.display;
+    size_t nextInput = 0;
+    for (long long frame = 0; frame < frames; ++frame) {
+        while (nextInput < movie.size() && movie[nextInput].frame <= frame) {
+            for (int key = 0; key < 16; ++key) {
+                chip8.keypad[key] = (movie[nextInput].keys >> key) & 1;
+            }
+            nextInput++;
+        }
+        if (latency && movie.empty() && (frame % 30 == 0 || frame % 30 == 6)) {
+            chip8.keypad.fill(0);
+            if (frame % 30 == 0) chip8.keypad[taps() & 0x0F] = 1;
+        }
+
+        // Latency is counted in emulated frames: a response within this frame is 1
+        if (latency) probe.Input(chip8.keypad, double(frame));
+        chip8.RunFrame(cycles);
+        const Chip8& shown = runAhead.Run(chip8, cycles);
+        runAheadInstructions += runAhead.Instructions();
+        if (latency) probe.Display(shown.display, double(frame + 1));
+        lastShown = shown.display;
+        sink.Submit(shown.display);
+        if (sink.Failed()) {
+            frames = frame + 1;
+            break;
+        }
+        if (!sheetPath.empty() && frame % sheetEvery == 0) {
+            sheet.Add(shown.display);
+        }
+
+        if (!turbo) {
+            nextFrame += kFrameTime;
+            std::this_thread::sleep_until(nextFrame);
+        }
+
+        if (metrics) {
+            metrics->Collect(chip8.counters);
+            metrics->Add(metrics->wallFrames);
+            if (!turbo) {
+                auto lag = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - nextFrame);
+                metrics->schedulerLagMicros.store(lag.count(), std::memory_order_relaxed);
+                if (lag > kFrameTime) metrics->Add(metrics->skippedFrames);
+            }
+        }
+    }
+    exporter.Stop();
+
+    bool recorded = sink.Close();
+    chip8.trace = nullptr;
+    bool traced = trace.Close();
+
+    if (!screenshotPath.empty()) {
+        std::vector<uint32_t> pixels;
+        Renderer::Render(lastShown, render, pixels);
+        if (!WriteImage(screenshotPath, pixels.data(), Chip8::kWidth * render.scale, Chip8::kHeight * render.scale)) {
+            return EXIT_FAILURE;
+        }
+    }
+    if (!sheetPath.empty() && !WriteImage(sheetPath, sheet.Pixels().data(), sheet.Width(), sheet.Height())) {
+        return EXIT_FAILURE;
+    }
+
+    std::chrono::duration<double> elapsed = clock::now() - start;
+    std::cerr << "Ran " << frames << " frames in " << elapsed.count() << " s";
+    if (!recordPath.empty()) {
+        std::cerr << ", recorded " << sink.FramesWritten() << " frames (" << sink.FramesEncoded() << " distinct)";
+    }
+    if (!tracePath.empty() && traced) {
+        std::cerr << ", traced " << trace.Records() << " instructions";
+    }
+    if (runAheadFrames > 0) {
+        std::cerr << ", ran " << runAheadInstructions << " instructions ahead for " << chip8.counters.instructions << " live";
+    }
+    std::cerr << "." << std::endl;
+
+    if (!recorded) {
+        std::cerr << "Recording to " << recordPath << " failed after " << sink.FramesWritten() << " frames." << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (!traced) {
+        std::cerr << "Trace " << tracePath << " is incomplete: writing it failed." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (chip8.Trapped()) {
+        std::cerr << "Trapped: " << Chip8::TrapName(chip8.trap) << " at 0x" << std::hex << chip8.pc
+                  << " (" << chip8.opcode << ")" << std::dec << " after " << chip8.counters.instructions << " instructions." << std::endl;
+    }
+
+    if (latency) {
+        std::cerr << "Input to display latency (emulated frames), " << probe.Unanswered() << " edges unanswered:\n";
+        probe.ToDisplay().Print(std::cerr, "frames");
+    }
+    return chip8.Trapped() ? EXIT_FAILURE : 0;
+}
@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../core/bundled.h"
+#include "../core/chip8.h"
+#include "../core/disassembler.h"
+#include "../core/hash.h"
+#include "../core/random.h"
+
+namespace {
+
+struct Options {
+    long long frames = 60 * 60;
+    int cycles = 16;
+    int interval = 64;
+    uint64_t seed = 0;
+    int runs = 1;
+    bool fuzz = false;
+    int hold = 6;
+    Quirks quirks;
+};
+
+// Prints every field that differs between the reference and candidate states
+void DumpDiff(const Chip8::State& reference, const Chip8::State& candidate) {
+    auto field = [](const char* name, int expected, int actual) {
+        if (expected != actual) std::printf("  %-8s reference %04X  candidate %04X\n", name, expected, actual);
+    };
+
+    field("pc", reference.pc, candidate.pc);
+    field("I", reference.index, candidate.index);
+    field("sp", reference.sp, candidate.sp);
+    field("DT", reference.delayTimer, candidate.delayTimer);
+    field("ST", reference.soundTimer, candidate.soundTimer);
+    field("opcode", reference.opcode, candidate.opcode);
+
+    char name[16];
+    for (int i = 0; i < 16; ++i) {
+        std::snprintf(name, sizeof(name), "V%X", i);
+        field(name, reference.registers[i], candidate.registers[i]);
+    }
+    for (int i = 0; i < 16; ++i) {
+        std::snprintf(name, sizeof(name), "stack[%X]", i);
+        field(name, reference.stack[i], candidate.stack[i]);
+    }
+    for (int i = 0; i < 4; ++i) {
+        std::snprintf(name, sizeof(name), "rng[%d]", i);
+        if (reference.rng[i] != candidate.rng[i]) {
+            std::printf("  %-8s reference %08X  candidate %08X\n", name, reference.rng[i], candidate.rng[i]);
+        }
+    }
+
+    int shown = 0;
+    for (int address = 0; address < 4096; ++address) {
+        if (reference.memory[address] == candidate.memory[address]) continue;
+        if (shown++ < 32) {
+            std::printf("  mem[%03X] reference %02X  candidate %02X\n", address, reference.memory[address], candidate.memory[address]);
+        }
+    }
+    if (shown > 32) std::printf("  ... %d memory bytes differ\n", shown);
+
+    int pixels = 0;
+    for (size_t i = 0; i < reference.display.size(); ++i) {
+        pixels += reference.display[i] != candidate.display[i];
+    }
+    if (pixels > 0) std::printf("  display  %d pixels differ\n", pixels);
+}
+
+// Both engines start from checkpoint and run the same chunk; the candidate is re-run from the
+// checkpoint for 1, 2, ... instructions until the first count whose result differs
+void Bisect(const Chip8::State& checkpoint, int chunk, long long executed, const Quirks& quirks) {
+    Chip8 reference;
+    Chip8 candidate;
+    reference.quirks = candidate.quirks = quirks;
+    reference.LoadState(checkpoint);
+
+    Chip8::State expected;
+    Chip8::State actual;
+    for (int count = 1; count <= chunk; ++count) {
+        uint16_t pc = reference.pc;
+        uint16_t opcode = reference.memory[pc & 0xFFF] << 8 | reference.memory[(pc + 1) & 0xFFF];
+        reference.Tick();
+        reference.SaveState(expected);
+
+        candidate.LoadState(checkpoint);
+        candidate.Run(count);
+        candidate.SaveState(actual);
+
+        if (HashState(expected) != HashState(actual)) {
+            std::printf("First divergent instruction #%lld: 0x%04X | %04X | %s\n", executed + count, pc, opcode, Disassemble(opcode).c_str());
+            DumpDiff(expected, actual);
+            return;
+        }
+    }
+    std::printf("Divergence did not reproduce instruction by instruction (chunk of %d from instruction #%lld)\n", chunk, executed);
+}
+
+// Runs one ROM through Tick (reference) and Run (candidate) on the same input stream.
+// Returns false at the first checkpoint where the state hashes differ.
+bool Validate(const std::vector<uint8_t>& rom, std::string_view name, const Options& options, uint64_t seed) {
+    Chip8 reference;
+    Chip8 candidate;
+    if (!reference.LoadRom(rom) || !candidate.LoadRom(rom)) {
+        std::cerr << name << ": unable to load ROM" << std::endl;
+        return false;
+    }
+    reference.quirks = candidate.quirks = options.quirks;
+
+    // The input stream has its own generator so fuzzed keys never perturb CXNN
+    Random input;
+    input.seed(seed, 1);
+    reference.rand.seed(seed);
+    candidate.rand.seed(seed);
+
+    Chip8::State checkpoint;
+    Chip8::State state;
+    reference.SaveState(checkpoint);
+    uint16_t keys = 0;
+
+    for (long long frame = 0; frame < options.frames; ++frame) {
+        if (options.fuzz && frame % options.hold == 0) {
+            // Mostly one or no key held, the way games are actually played
+            uint8_t roll = input();
+            keys = roll < 96 ? 0 : roll < 224 ? uint16_t(1 << (input() & 0x0F)) : uint16_t(input() << 8 | input());
+        }
+        for (int key = 0; key < 16; ++key) {
+            reference.keypad[key] = candidate.keypad[key] = (keys >> key) & 1;
+        }
+
+        // Checkpoints never straddle a timer tick, so a chunk is pure instruction execution
+        for (int done = 0; done < options.cycles;) {
+            int chunk = std::min(options.interval, options.cycles - done);
+            long long executed = static_cast<long long>(reference.counters.instructions);
+            reference.SaveState(checkpoint);
+            for (int i = 0; i < chunk; ++i) {
+                reference.Tick();
+            }
+            candidate.Run(chunk);
+
+            reference.SaveState(state);
+            uint64_t expected = HashState(state);
+            candidate.SaveState(state);
+            if (expected != HashState(state)) {
+                std::printf("%.*s: DIVERGED in frame %lld (seed %llu)\n", int(name.size()), name.data(), frame, (unsigned long long)seed);
+                Bisect(checkpoint, chunk, executed, options.quirks);
+                return false;
+            }
+
+            done += chunk;
+        }
+
+        reference.TickTimer();
+        candidate.TickTimer();
+    }
+
+    // What the engines actually ran, less than frames * cycles when the ROM traps or waits for a key
+    std::printf("%.*s: ok, %llu instructions (seed %llu)", int(name.size()), name.data(),
+        (unsigned long long)reference.counters.instructions, (unsigned long long)seed);
+    if (reference.Trapped()) {
+        std::printf(", both trapped: %s at 0x%03X (%04X)", Chip8::TrapName(reference.trap), reference.pc, reference.opcode);
+    }
+    std::printf("\n");
+    return true;
+}
+
+// Replays each bundled ROM's boot through Tick() and compares the state the compiler baked
+bool ValidateBundled() {
+    bool valid = true;
+    for (const BundledRom& entry : BundledRoms()) {
+        const BakedBoot& boot = *entry.boot;
+        Chip8 reference;
+        if (!reference.LoadRom(entry.rom)) {
+            std::cerr << entry.file << ": unable to load ROM" << std::endl;
+            valid = false;
+            continue;
+        }
+        for (uint32_t i = 0; i < boot.instructions; ++i) {
+            reference.Tick();
+            if ((i + 1) % boot.cycles == 0) reference.TickTimer();
+        }
+
+        Chip8::State expected;
+        reference.SaveState(expected);
+        Chip8::State baked = boot.state;
+        baked.rng = expected.rng;
+        if (HashState(expected) != HashState(baked)) {
+            std::printf("%.*s: baked boot DIVERGED after %u instructions\n", int(entry.file.size()), entry.file.data(), boot.instructions);
+            DumpDiff(expected, baked);
+            valid = false;
+            continue;
+        }
+        std::printf("%.*s: baked boot ok, %u instructions, %u frames, stopped at 0x%03X (%04X)\n", int(entry.file.size()),
+            entry.file.data(), boot.instructions, boot.frames, baked.pc, reference.memory[baked.pc & 0xFFF] << 8 | reference.memory[(baked.pc + 1) & 0xFFF]);
+    }
+    return valid;
+}
+
+bool ReadRom(const std::filesystem::path& path, std::vector<uint8_t>& rom) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    rom.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !rom.empty() && rom.size() <= Chip8::kMaxRomSize;
+}
+
+} // namespace
+
+// Differential validation of the fused Run() engine against the reference Tick() interpreter.
+// Accepts a ROM or a directory of ROMs; --fuzz drives the keypad from a seeded random stream.
+// --bundled checks the boot states baked into the build instead.
+int main(int argc, char** argv) {
+    std::string_view target;
+    Options options;
+    bool bundled = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc) {
+            options.frames = std::atoll(argv[++i]);
+        } else if (arg == "--cycles" && i + 1 < argc) {
+            options.cycles = std::atoi(argv[++i]);
+        } else if (arg == "--interval" && i + 1 < argc) {
+            options.interval = std::atoi(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--runs" && i + 1 < argc) {
+            options.runs = std::atoi(argv[++i]);
+        } else if (arg == "--hold" && i + 1 < argc) {
+            options.hold = std::atoi(argv[++i]);
+        } else if (arg == "--quirks" && i + 1 < argc) {
+            auto profile = ParseProfile(argv[++i]);
+            if (!profile) {
+                options.runs = 0;
+                break;
+            }
+            options.quirks = QuirksFor(*profile);
+        } else if (arg == "--fuzz") {
+            options.fuzz = true;
+        } else if (arg == "--bundled") {
+            bundled = true;
+        } else if (target.empty()) {
+            target = arg;
+        } else {
+            target = {};
+            break;
+        }
+    }
+
+    if (bundled && target.empty()) {
+        return ValidateBundled() ? 0 : EXIT_FAILURE;
+    }
+
+    if (target.empty() || options.cycles <= 0 || options.interval <= 0 || options.hold <= 0 || options.runs <= 0) {
+        std::cerr << "Usage: " << argv[0] << " <Rom|directory> [--frames N] [--cycles N] [--interval N] [--fuzz] [--hold N] [--seed N] [--runs N]\n"
+                  << "    [--quirks default|chip8|schip|xochip]\n"
+                  << "       " << argv[0] << " --bundled" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::filesystem::path> roms;
+    std::error_code error;
+    if (std::filesystem::is_directory(target, error)) {
+        for (const auto& entry : std::filesystem::directory_iterator(target, error)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".ch8") {
+                roms.push_back(entry.path());
+            }
+        }
+        std::sort(roms.begin(), roms.end());
+    } else {
+        roms.emplace_back(target);
+    }
+
+    int failures = 0;
+    for (const auto& path : roms) {
+        std::vector<uint8_t> rom;
+        if (!ReadRom(path, rom)) {
+            std::cerr << "Unable to load specified ROM: " << path.string() << std::endl;
+            failures++;
+            continue;
+        }
+        for (int run = 0; run < options.runs; ++run) {
+            if (!Validate(rom, path.filename().string(), options, options.seed + run)) {
+                failures++;
+                break;
+            }
+        }
+    }
+
+    return failures == 0 ? 0 : EXIT_FAILURE;
+}
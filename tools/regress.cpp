@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "../core/chip8.h"
+#include "../core/hash.h"
+#include "../core/movie.h"
+
+namespace {
+
+// One manifest line:
+//   <rom> <frames> <cycles per frame> <display hash> <memory hash> [input movie]
+// Paths are relative to the manifest; movies are in the format read by ReadMovie().
+struct Case {
+    std::string rom;
+    long long frames = 0;
+    int cycles = 16;
+    uint64_t displayHash = 0;
+    uint64_t memoryHash = 0;
+    std::string movie;
+
+    // Filled in by the run
+    uint64_t actualDisplay = 0;
+    uint64_t actualMemory = 0;
+    long long instructions = 0;
+    double seconds = 0.0;
+    std::string error;
+};
+
+bool ReadFile(const std::filesystem::path& path, std::vector<uint8_t>& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+bool ReadManifest(const std::filesystem::path& path, std::vector<Case>& cases) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open manifest: " << path.string() << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int number = 0;
+    while (std::getline(file, line)) {
+        number++;
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream fields(line);
+        Case test;
+        if (!(fields >> test.rom >> test.frames >> test.cycles >> std::hex >> test.displayHash >> test.memoryHash)) {
+            std::cerr << path.string() << ":" << number << ": malformed manifest line" << std::endl;
+            return false;
+        }
+        fields >> test.movie;
+        cases.push_back(std::move(test));
+    }
+    return true;
+}
+
+// Runs one case headless from reset, with the fused engine and no GL context
+void Run(Case& test, const std::filesystem::path& base) {
+    std::vector<uint8_t> rom;
+    if (!ReadFile(base / test.rom, rom)) {
+        test.error = "unable to read ROM";
+        return;
+    }
+
+    std::vector<MovieInput> movie;
+    if (!test.movie.empty() && !ReadMovie(base / test.movie, movie)) {
+        test.error = "unable to read input movie";
+        return;
+    }
+
+    Chip8 chip8;
+    if (!chip8.LoadRom(rom)) {
+        test.error = "unable to load ROM";
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    size_t next = 0;
+    for (long long frame = 0; frame < test.frames; ++frame) {
+        while (next < movie.size() && movie[next].frame <= frame) {
+            for (int key = 0; key < 16; ++key) {
+                chip8.keypad[key] = (movie[next].keys >> key) & 1;
+            }
+            next++;
+        }
+        test.instructions += chip8.Run(test.cycles);
+        chip8.TickTimer();
+    }
+    test.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    test.actualDisplay = HashDisplay(chip8.display);
+    test.actualMemory = HashMemory(chip8.memory);
+
+    // A golden run never traps, so a trap is a failure even if the hashes happen to match
+    if (chip8.Trapped()) {
+        char where[64];
+        std::snprintf(where, sizeof(where), "trapped: %s at 0x%03X (%04X)", Chip8::TrapName(chip8.trap), chip8.pc, chip8.opcode);
+        test.error = where;
+    }
+}
+
+} // namespace
+
+// Runs every case of a regression manifest concurrently and compares the final display and
+// memory against the golden hashes. --update prints the manifest with the hashes just computed.
+int main(int argc, char** argv) {
+    std::string_view manifestPath;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    bool update = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--update") {
+            update = true;
+        } else if (manifestPath.empty()) {
+            manifestPath = arg;
+        } else {
+            manifestPath = {};
+            break;
+        }
+    }
+
+    if (manifestPath.empty()) {
+        std::cerr << "Usage: " << argv[0] << " <manifest> [--threads N] [--update]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Case> cases;
+    if (!ReadManifest(std::filesystem::path(manifestPath), cases)) {
+        return EXIT_FAILURE;
+    }
+    auto base = std::filesystem::path(manifestPath).parent_path();
+
+    // Workers pull the next case index until the manifest is exhausted
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<size_t> nextCase = 0;
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < std::min<size_t>(threads, cases.size()); ++i) {
+        workers.emplace_back([&] {
+            for (size_t at; (at = nextCase.fetch_add(1, std::memory_order_relaxed)) < cases.size();) {
+                Run(cases[at], base);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (update) {
+        std::printf("# rom  frames  cycles/frame  display hash  memory hash  [input movie]\n");
+        for (const auto& test : cases) {
+            std::printf("%s %lld %d %016" PRIx64 " %016" PRIx64 "%s%s\n", test.rom.c_str(), test.frames, test.cycles,
+                test.actualDisplay, test.actualMemory, test.movie.empty() ? "" : " ", test.movie.c_str());
+        }
+        return 0;
+    }
+
+    int failures = 0;
+    long long instructions = 0;
+    for (const auto& test : cases) {
+        bool displayOk = test.actualDisplay == test.displayHash;
+        bool memoryOk = test.actualMemory == test.memoryHash;
+        bool pass = test.error.empty() && displayOk && memoryOk;
+        failures += !pass;
+        instructions += test.instructions;
+
+        double mips = test.seconds > 0 ? test.instructions / test.seconds / 1e6 : 0.0;
+        std::printf("%-4s %-28s %8.1f MIPS", pass ? "PASS" : "FAIL", test.rom.c_str(), mips);
+        if (!test.error.empty()) {
+            std::printf("  %s", test.error.c_str());
+        } else {
+            if (!displayOk) std::printf("  display %016" PRIx64 " != %016" PRIx64, test.actualDisplay, test.displayHash);
+            if (!memoryOk) std::printf("  memory %016" PRIx64 " != %016" PRIx64, test.actualMemory, test.memoryHash);
+        }
+        std::printf("\n");
+    }
+
+    std::printf("%zu cases, %d failed, %lld instructions in %.2f s on %zu threads\n", cases.size(), failures, instructions,
+        elapsed, std::min<size_t>(threads, cases.size()));
+    return failures == 0 ? 0 : EXIT_FAILURE;
+}
@@ -0,0 +1,397 @@
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../core/chip8.h"
+#include "../core/metrics.h"
+#include "server_protocol.h"
+
+using namespace chip8_server;
+
+namespace {
+
+volatile std::sig_atomic_t running = 1;
+
+void Stop(int) {
+    running = 0;
+}
+
+// A client that doesn't take its replies for this long is dropped instead of stalling the others
+constexpr int kWriteTimeoutMs = 1000;
+
+// Client sockets are non-blocking; a full send buffer waits for room up to kWriteTimeoutMs
+bool WriteFully(int fd, const void* data, size_t size) {
+    auto* in = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t n = write(fd, in, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            pollfd writable = { fd, POLLOUT, 0 };
+            if (poll(&writable, 1, kWriteTimeoutMs) <= 0) return false;
+            continue;
+        }
+        if (n <= 0) return false;
+        in += n;
+        size -= n;
+    }
+    return true;
+}
+
+// Hosts the emulator instances and the shared observation segment
+class Server {
+public:
+    Server(uint32_t instances, int cycles, uint64_t seed) : cycles(cycles), seed(seed), machines(instances), slots(instances), frames(instances, 0), reported(instances, false) {
+        for (auto& instance : slots) {
+            instance.resize(kSaveSlots);
+        }
+        for (uint32_t i = 0; i < instances; ++i) {
+            metrics.push_back(&registry.Add(std::to_string(i)));
+        }
+    }
+
+    [[nodiscard]] MetricsRegistry& Metrics() { return registry; }
+
+    ~Server() {
+        if (shared) munmap(shared, sharedSize);
+        if (!shmName.empty()) shm_unlink(shmName.c_str());
+    }
+
+    bool LoadRom(std::string_view rom) {
+        if (!machines[0].LoadRom(rom)) return false;
+        machines[0].SaveState(bootState);
+
+        // All instances share the ROM image's pages until they write to them
+        for (uint32_t i = 0; i < machines.size(); ++i) {
+            machines[i].LoadRom(machines[0].memory.Image());
+            Boot(i);
+        }
+        return true;
+    }
+
+    bool MapShared(const std::string& name) {
+        sharedSize = sizeof(SharedHeader) + sizeof(Observation) * machines.size();
+        // Observations start on their own cache line
+        sharedSize += alignof(Observation);
+
+        int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+        if (fd < 0) {
+            std::cerr << "shm_open failed: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        shmName = name;
+
+        if (ftruncate(fd, sharedSize) != 0) {
+            std::cerr << "ftruncate failed: " << std::strerror(errno) << std::endl;
+            close(fd);
+            return false;
+        }
+
+        void* mapping = mmap(nullptr, sharedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            std::cerr << "mmap failed: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        shared = static_cast<uint8_t*>(mapping);
+        auto* header = reinterpret_cast<SharedHeader*>(shared);
+        header->magic = kMagic;
+        header->version = kVersion;
+        header->instances = static_cast<uint32_t>(machines.size());
+        header->observationSize = sizeof(Observation);
+        observations = reinterpret_cast<Observation*>(shared + alignof(Observation));
+
+        for (uint32_t i = 0; i < machines.size(); ++i) {
+            Publish(i);
+        }
+        return true;
+    }
+
+    // Executes one batch in order, publishing each touched instance once at the end
+    void Execute(const std::vector<Request>& batch, std::vector<Status>& results) {
+        results.resize(batch.size());
+        touched.assign(machines.size(), false);
+
+        for (size_t i = 0; i < batch.size(); ++i) {
+            results[i] = Execute(batch[i]);
+            if (results[i] == Status::Ok || results[i] == Status::Trapped) {
+                touched[batch[i].instance] = true;
+            }
+        }
+
+        for (uint32_t i = 0; i < machines.size(); ++i) {
+            if (touched[i]) Publish(i);
+        }
+    }
+
+private:
+    Status Execute(const Request& request) {
+        if (request.instance >= machines.size()) return Status::BadInstance;
+        auto& chip8 = machines[request.instance];
+
+        switch (request.command) {
+        case Command::Reset:
+            Boot(request.instance);
+            frames[request.instance] = 0;
+            return Status::Ok;
+
+        case Command::Step:
+            for (int key = 0; key < 16; ++key) {
+                chip8.keypad[key] = (request.keys >> key) & 1;
+            }
+            for (uint32_t frame = 0; frame < request.arg; ++frame) {
+                chip8.RunFrame(cycles);
+            }
+            frames[request.instance] += request.arg;
+            if (chip8.Trapped()) [[unlikely]] {
+                // Only this instance halts; say so once, when it happens
+                if (!reported[request.instance]) {
+                    std::cerr << "Instance " << request.instance << " trapped: " << Chip8::TrapName(chip8.trap) << " at 0x"
+                              << std::hex << chip8.pc << " (" << chip8.opcode << ")" << std::dec << std::endl;
+                    reported[request.instance] = true;
+                }
+                return Status::Trapped;
+            }
+            reported[request.instance] = false;
+            return Status::Ok;
+
+        case Command::SaveState:
+            if (request.arg >= kSaveSlots) return Status::BadSlot;
+            if (!slots[request.instance][request.arg]) {
+                slots[request.instance][request.arg] = std::make_unique<Chip8::State>();
+            }
+            chip8.SaveState(*slots[request.instance][request.arg]);
+            return Status::Ok;
+
+        case Command::LoadState:
+            if (request.arg >= kSaveSlots) return Status::BadSlot;
+            if (!slots[request.instance][request.arg]) return Status::EmptySlot;
+            chip8.LoadState(*slots[request.instance][request.arg]);
+            return Status::Ok;
+
+        default:
+            return Status::BadCommand;
+        }
+    }
+
+    // Every instance starts from the same boot state but draws from its own random stream
+    void Boot(uint32_t instance) {
+        machines[instance].LoadState(bootState);
+        machines[instance].rand.seed(seed, instance);
+    }
+
+    void Publish(uint32_t instance) {
+        const auto& chip8 = machines[instance];
+        auto& obs = observations[instance];
+
+        std::memcpy(obs.display, chip8.display.data(), sizeof(obs.display));
+        std::memcpy(obs.registers, chip8.registers.data(), sizeof(obs.registers));
+        std::memcpy(obs.stack, chip8.stack.data(), sizeof(obs.stack));
+        obs.pc = chip8.pc;
+        obs.index = chip8.index;
+        obs.sp = chip8.sp;
+        obs.delayTimer = chip8.delayTimer;
+        obs.soundTimer = chip8.soundTimer;
+        obs.trap = static_cast<uint8_t>(chip8.trap);
+        obs.frame = frames[instance];
+
+        // Metrics follow the observations: once per touched instance per batch
+        metrics[instance]->Collect(chip8.counters);
+        metrics[instance]->Add(metrics[instance]->wallFrames);
+    }
+
+    int cycles;
+    uint64_t seed;
+    std::vector<Chip8> machines;
+    std::vector<std::vector<std::unique_ptr<Chip8::State>>> slots;
+    std::vector<uint64_t> frames;
+    std::vector<bool> touched;
+    std::vector<bool> reported;
+    Chip8::State bootState;
+    MetricsRegistry registry;
+    std::vector<InstanceMetrics*> metrics;
+
+    std::string shmName;
+    uint8_t* shared = nullptr;
+    size_t sharedSize = 0;
+    Observation* observations = nullptr;
+};
+
+int Listen(const std::string& path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        std::cerr << "socket failed: " << std::strerror(errno) << std::endl;
+        return -1;
+    }
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Socket path too long: " << path << std::endl;
+        close(fd);
+        return -1;
+    }
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(path.c_str());
+
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 16) != 0) {
+        std::cerr << "bind/listen failed: " << std::strerror(errno) << std::endl;
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Appends whatever the client has sent to its receive buffer, then runs every batch that has fully
+// arrived and sends back the statuses. A partial batch waits in the buffer for the next poll, so a
+// slow or stalled client never holds up the others. False drops the client.
+bool Serve(int client, std::vector<uint8_t>& received, Server& server, std::vector<Request>& batch, std::vector<Status>& results) {
+    uint8_t block[64 * 1024];
+    bool closed = false;
+    while (true) {
+        ssize_t n = read(client, block, sizeof(block));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n < 0) return false;
+        if (n == 0) {
+            // Batches that arrived before the client shut down its end are still answered
+            closed = true;
+            break;
+        }
+        received.insert(received.end(), block, block + n);
+    }
+
+    size_t at = 0;
+    while (received.size() - at >= sizeof(uint32_t)) {
+        uint32_t count = 0;
+        std::memcpy(&count, received.data() + at, sizeof(count));
+        if (count > kMaxBatch) return false;
+
+        size_t size = sizeof(count) + count * sizeof(Request);
+        if (received.size() - at < size) break;
+
+        batch.resize(count);
+        std::memcpy(batch.data(), received.data() + at + sizeof(count), count * sizeof(Request));
+        at += size;
+
+        server.Execute(batch, results);
+        if (!WriteFully(client, &count, sizeof(count)) || !WriteFully(client, results.data(), count * sizeof(Status))) return false;
+    }
+    received.erase(received.begin(), received.begin() + at);
+    return !closed;
+}
+
+} // namespace
+
+// Hosts many Chip8 instances of one ROM for external drivers (training and test harnesses)
+int main(int argc, char** argv) {
+    std::string_view rom;
+    std::string socketPath = "/tmp/chip8.sock";
+    std::string shmName = "/chip8_observations";
+    std::string metricsPath;
+    std::string metricsSocket;
+    uint32_t instances = 1;
+    int cycles = 16;
+    uint64_t seed = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else if (arg == "--shm" && i + 1 < argc) {
+            shmName = argv[++i];
+        } else if (arg == "--instances" && i + 1 < argc) {
+            instances = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--cycles" && i + 1 < argc) {
+            cycles = std::atoi(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--metrics" && i + 1 < argc) {
+            metricsPath = argv[++i];
+        } else if (arg == "--metrics-socket" && i + 1 < argc) {
+            metricsSocket = argv[++i];
+        } else if (rom.empty()) {
+            rom = arg;
+        } else {
+            rom = {};
+            break;
+        }
+    }
+
+    if (rom.empty() || instances == 0) {
+        std::cerr << "Usage: " << argv[0] << " <Rom> [--instances N] [--socket PATH] [--shm NAME] [--cycles N] [--seed N]\n"
+                  << "    [--metrics out.prom] [--metrics-socket PATH]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Server server(instances, cycles, seed);
+    if (!server.LoadRom(rom) || !server.MapShared(shmName)) {
+        return EXIT_FAILURE;
+    }
+
+    MetricsExporter exporter(server.Metrics());
+    if ((!metricsPath.empty() || !metricsSocket.empty()) && !exporter.Start(metricsPath, metricsSocket)) {
+        return EXIT_FAILURE;
+    }
+
+    int listener = Listen(socketPath);
+    if (listener < 0) {
+        return EXIT_FAILURE;
+    }
+
+    std::signal(SIGINT, Stop);
+    std::signal(SIGTERM, Stop);
+    std::signal(SIGPIPE, SIG_IGN);
+    std::cerr << "Serving " << instances << " instances on " << socketPath << ", observations in " << shmName << std::endl;
+
+    std::vector<pollfd> fds = { { listener, POLLIN, 0 } };
+    std::unordered_map<int, std::vector<uint8_t>> received;
+    std::vector<Request> batch;
+    std::vector<Status> results;
+
+    while (running) {
+        if (poll(fds.data(), fds.size(), 500) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (size_t i = 1; i < fds.size(); ++i) {
+            if (fds[i].revents == 0) continue;
+            if (!(fds[i].revents & POLLIN) || !Serve(fds[i].fd, received[fds[i].fd], server, batch, results)) {
+                received.erase(fds[i].fd);
+                close(fds[i].fd);
+                fds[i].fd = -1;
+            }
+        }
+        std::erase_if(fds, [](const pollfd& p) { return p.fd < 0; });
+
+        if (fds[0].revents & POLLIN) {
+            int client = accept(listener, nullptr, nullptr);
+            if (client >= 0 && fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK) == 0) {
+                fds.push_back({ client, POLLIN, 0 });
+            } else if (client >= 0) {
+                close(client);
+            }
+        }
+    }
+
+    for (auto& p : fds) {
+        close(p.fd);
+    }
+    unlink(socketPath.c_str());
+    return 0;
+}
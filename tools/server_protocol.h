@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+
+// Wire format shared between chip8_server and its clients.
+//
+// Commands travel over a Unix domain stream socket as one batch per message:
+//   uint32_t count, followed by count Request records.
+// The server answers every batch with:
+//   uint32_t count, followed by count Status bytes (one per request, same order).
+//
+// Observations are never sent over the socket. After a batch completes, every instance it
+// touched has its Observation rewritten in the POSIX shared-memory segment, which clients
+// map read-only and read in place.
+namespace chip8_server {
+
+constexpr uint32_t kMagic = 0x56533843; // "C8SV"
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kSaveSlots = 8;
+constexpr uint32_t kMaxBatch = 65536;
+
+enum class Command : uint8_t {
+    Reset,      // Reload the ROM's boot state
+    Step,       // Run arg frames with the keypad mask in keys
+    SaveState,  // Save to server-side slot arg
+    LoadState,  // Restore from server-side slot arg
+};
+
+enum class Status : uint8_t {
+    Ok,
+    BadInstance,
+    BadCommand,
+    BadSlot,
+    EmptySlot,
+    Trapped,    // Step ran but the instance is halted on a trap (see Observation::trap) until Reset or LoadState
+};
+
+struct Request {
+    Command command;
+    uint8_t reserved;
+    uint16_t keys;      // Bit n set = key n held (Step only)
+    uint32_t instance;
+    uint32_t arg;
+};
+static_assert(sizeof(Request) == 12);
+
+// Layout of the shared-memory segment: a SharedHeader followed by one Observation per instance
+struct SharedHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t instances;
+    uint32_t observationSize;
+};
+
+struct alignas(64) Observation {
+    uint8_t display[64 * 32];   // One byte per pixel, 0 or 1
+    uint8_t registers[16];
+    uint16_t stack[16];
+    uint16_t pc;
+    uint16_t index;
+    uint8_t sp;
+    uint8_t delayTimer;
+    uint8_t soundTimer;
+    uint8_t trap;               // Chip8::Trap, 0 while running; pc is then the faulting address
+    uint64_t frame;             // Frames stepped since the last reset
+};
+
+} // namespace chip8_server
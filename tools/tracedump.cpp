@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "../core/disassembler.h"
+#include "../core/trace.h"
+
+// Decodes a binary trace written by TraceRecorder into one text line per instruction:
+//   <n> | <pc> | <opcode> | <disassembly> | <changed registers and I>
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <trace.c8t>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::FILE* file = std::fopen(argv[1], "rb");
+    if (!file) {
+        std::cerr << "Failed to open trace: " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    char magic[sizeof(kTraceMagic)];
+    if (std::fread(magic, 1, sizeof(magic), file) != sizeof(magic) || std::memcmp(magic, kTraceMagic, sizeof(magic)) != 0) {
+        std::cerr << "Not a Chip-8 trace file." << std::endl;
+        std::fclose(file);
+        return EXIT_FAILURE;
+    }
+
+    // Decodes from a sliding window so a trace of any length runs in constant memory. The
+    // window is refilled whenever less than one full record is left in it.
+    constexpr size_t kWindow = 64 * 1024;
+    constexpr size_t kMaxRecord = 1 + 2 + 2 + 2 + 2 + 16;
+    std::vector<uint8_t> data(kWindow + 32, 0);
+    size_t at = 0;
+    size_t end = 0;
+    bool eof = false;
+    auto refill = [&]() {
+        std::memmove(data.data(), data.data() + at, end - at);
+        end -= at;
+        at = 0;
+        size_t n = std::fread(data.data() + end, 1, kWindow - end, file);
+        end += n;
+        eof = n == 0;
+        // Zero padding keeps a record truncated by a crash from reading past the buffer
+        std::fill(data.begin() + end, data.end(), 0);
+    };
+    refill();
+
+    auto get16 = [&]() {
+        uint16_t value = data[at] | (data[at + 1] << 8);
+        at += 2;
+        return value;
+    };
+
+    uint16_t pc = 0;
+    uint64_t count = 0;
+    char line[256];
+
+    while (true) {
+        if (end - at < kMaxRecord && !eof) refill();
+        if (at >= end) break;
+
+        uint8_t flags = data[at++];
+        if (flags & kTracePc) pc = get16();
+        uint16_t opcode = get16();
+
+        int length = std::snprintf(line, sizeof(line), "%10llu | 0x%04X | %04X | %-16s |",
+            static_cast<unsigned long long>(count), pc, opcode, Disassemble(opcode).c_str());
+
+        if (flags & kTraceIndex) {
+            length += std::snprintf(line + length, sizeof(line) - length, " I=%04X", get16());
+        }
+        if (flags & kTraceRegisters) {
+            uint16_t mask = get16();
+            for (int i = 0; i < 16; ++i) {
+                if (mask & (1 << i)) {
+                    length += std::snprintf(line + length, sizeof(line) - length, " V%X=%02X", i, data[at++]);
+                }
+            }
+        }
+
+        std::puts(line);
+        pc += 2;
+        count++;
+    }
+    std::fclose(file);
+
+    return 0;
+}